@@ -0,0 +1,75 @@
+#    This is a part of the Razmer2M project
+#    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+# Print the serial link and display budget of the configuration
+# Mirrors the constexpr budget in uart.h and display.h; the static_asserts there
+# are what fails the build, this is only the configure-time summary.
+function(print_budget)
+    set(_f_cpu 16000000)
+    set(_spi_prescaler 128)
+    set(_spi_isr_cycles 60)
+    set(_stamp_line 11)
+    set(_status_rate 4)
+    set(_memory_line 17)
+    set(_memory_period 10)
+
+    # Serial link
+    if(AXIS_DOT_POSITION LESS AXIS_DIGIT_COUNT)
+        set(_field 10)
+    else()
+        set(_field 9)
+    endif()
+    math(EXPR _line "${AXIS_COUNT} * ${_field}")
+    math(EXPR _frame_x100 "(${_line} + ${_stamp_line}) * 100 + (1 + ${_status_rate}) * ${_stamp_line} * 100 / ${FRAME_RATE}
+                           + ${_memory_line} * 100 / (${FRAME_RATE} * ${_memory_period})")
+    math(EXPR _link_load "${_frame_x100} * 10 * ${FRAME_RATE} * 10 / ${BAUDRATE}")
+    math(EXPR _link_max "${BAUDRATE} * 100 / 10 / ${_frame_x100}")
+
+    # Display
+    math(EXPR _byte_ns "8 * (1000000000 / (${_f_cpu} / ${_spi_prescaler})) + ${_spi_isr_cycles} * (1000000000 / ${_f_cpu})")
+    math(EXPR _paint_us "9 * (${AXIS_COUNT} * 2 * ${_byte_ns} / 1000 + 10)")
+    math(EXPR _paint_load "${_paint_us} * ${FRAME_RATE} / 1000")
+    math(EXPR _paint_max "1000000 / ${_paint_us}")
+
+    # NCU status: the line on the wire, the status line, and two paints on the receiver
+    set(_longest ${_line})
+    if(_longest LESS 17)
+        set(_longest 17)
+    endif()
+    math(EXPR _alert_us "(${_longest} + ${_stamp_line}) * 10 * 1000000 / ${BAUDRATE} + 2 * ${_paint_us}")
+
+    if(_link_max LESS _paint_max)
+        set(_max ${_link_max})
+    else()
+        set(_max ${_paint_max})
+    endif()
+
+    math(EXPR _link_pct "${_link_load} / 10")
+    math(EXPR _link_frac "${_link_load} % 10")
+    math(EXPR _paint_pct "${_paint_load} / 10")
+    math(EXPR _paint_frac "${_paint_load} % 10")
+    math(EXPR _frame_bytes "${_frame_x100} / 100")
+
+    message(STATUS "Budget at ${FRAME_RATE} Hz: link ${_frame_bytes} bytes/frame, "
+                   "${_link_pct}.${_link_frac}% of ${BAUDRATE} baud (max ${_link_max} Hz)")
+    message(STATUS "Budget at ${FRAME_RATE} Hz: display paint ${_paint_us} us/frame, "
+                   "${_paint_pct}.${_paint_frac}% (max ${_paint_max} Hz)")
+    message(STATUS "Budget: highest frame rate ${_max} Hz")
+    message(STATUS "Budget: NCU status to display at most ${_alert_us} us")
+    if(_link_load GREATER 1000 OR _paint_load GREATER 1000)
+        message(WARNING "Frame rate ${FRAME_RATE} Hz exceeds the budget, the firmware build will fail")
+    endif()
+endfunction()
@@ -0,0 +1,75 @@
+#    This is a part of the Razmer2M project
+#    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+# Flash cost of the extra receiver layouts (see include/layout.h)
+# target_layout_cost() adds, outside of the default build, one receiver image per extra layout
+# with only that layout added to the build layout, and a target that prints how much flash each
+# one costs over the single layout image:
+#   Layout 364: +1180 bytes of flash
+#   All 2 layouts (razmer2m_receiver): +2210 bytes of flash
+# This file is both included (target_layout_cost) and run by that target (cmake -P).
+
+if(NOT CMAKE_SCRIPT_MODE_FILE)
+    function(target_layout_cost target defs codes)
+        set(_base ${target}_layout_base)
+        add_executable(${_base} EXCLUDE_FROM_ALL main.cpp)
+        target_compile_definitions(${_base} PRIVATE ${defs})
+        set(_variants "")
+        set(_depends ${target} ${_base})
+        foreach(_code IN LISTS codes)
+            set(_variant ${target}_layout_${_code})
+            add_executable(${_variant} EXCLUDE_FROM_ALL main.cpp)
+            target_compile_definitions(${_variant} PRIVATE ${defs} RECEIVER_LAYOUTS=${_code})
+            list(APPEND _variants "${_code}=$<TARGET_FILE:${_variant}>")
+            list(APPEND _depends ${_variant})
+        endforeach()
+        list(JOIN _variants "|" _variants)
+        list(LENGTH codes _count)
+        add_custom_target(${target}_layout_cost
+            COMMAND ${CMAKE_COMMAND} -DSIZE=${CMAKE_SIZE} -DBASE=$<TARGET_FILE:${_base}>
+                    -DFULL=$<TARGET_FILE:${target}> -DNAME=${target} -DCOUNT=${_count}
+                    -DVARIANTS=${_variants} -P ${CMAKE_CURRENT_FUNCTION_LIST_FILE}
+            DEPENDS ${_depends}
+            COMMENT "Flash cost of the extra layouts of ${target}"
+            VERBATIM
+        )
+    endfunction()
+    return()
+endif()
+
+# Flash bytes of an image: .text and the .data initializers
+function(flash_size elf out)
+    execute_process(COMMAND ${SIZE} -A ${elf} OUTPUT_VARIABLE _sections)
+    set(_bytes 0)
+    foreach(_section text data)
+        if(_sections MATCHES "\n\\.${_section}[ \t]+([0-9]+)")
+            math(EXPR _bytes "${_bytes} + ${CMAKE_MATCH_1}")
+        endif()
+    endforeach()
+    set(${out} ${_bytes} PARENT_SCOPE)
+endfunction()
+
+flash_size(${BASE} _base)
+string(REPLACE "|" ";" _variants "${VARIANTS}")
+foreach(_variant IN LISTS _variants)
+    string(REGEX MATCH "^([0-9]+)=(.*)$" _ "${_variant}")
+    flash_size(${CMAKE_MATCH_2} _size)
+    math(EXPR _cost "${_size} - ${_base}")
+    message(STATUS "Layout ${CMAKE_MATCH_1}: +${_cost} bytes of flash")
+endforeach()
+flash_size(${FULL} _full)
+math(EXPR _cost "${_full} - ${_base}")
+message(STATUS "All ${COUNT} layouts (${NAME}): +${_cost} bytes of flash")
@@ -0,0 +1,118 @@
+#    This is a part of the Razmer2M project
+#    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+# SRAM report of a firmware target, printed after every build:
+#   receiver: SRAM 1187 of 2048 bytes (.data 64, .bss 1123), 612 bytes of constants kept in flash
+#   receiver: RAM map: uart 402, receiver 310, display 106, ...
+# The constants in flash are the PROGMEM tables and strings (see flash.h) that would otherwise be
+# copied to SRAM at startup, taken from the .progmem.data input sections in the linker map.
+# The RAM map adds up the .data and .bss symbols of every namespace (module); the stack gets what
+# is left, its high-water mark is reported at runtime (see ram.h).
+# This file is both included (target_sram_report) and run as the post-build script (cmake -P).
+
+set(SRAM_SIZE 2048)
+
+if(NOT CMAKE_SCRIPT_MODE_FILE)
+    function(target_sram_report target name)
+        set(_map ${CMAKE_CURRENT_BINARY_DIR}/${target}.map)
+        target_link_options(${target} PRIVATE -Wl,-Map=${_map})
+        add_custom_command(
+            TARGET ${target}
+            POST_BUILD
+            COMMAND ${CMAKE_COMMAND} -DNAME=${name} -DELF=$<TARGET_FILE:${target}> -DMAP=${_map}
+                    -DSIZE=${CMAKE_SIZE} -DNM=${CMAKE_NM} -P ${CMAKE_CURRENT_FUNCTION_LIST_FILE}
+            COMMENT "SRAM report of ${name}"
+            VERBATIM
+        )
+    endfunction()
+    return()
+endif()
+
+# Section sizes of the ELF file
+execute_process(COMMAND ${SIZE} -A ${ELF} OUTPUT_VARIABLE _sections RESULT_VARIABLE _result)
+if(NOT _result EQUAL 0)
+    message(WARNING "${NAME}: ${SIZE} failed, no SRAM report")
+    return()
+endif()
+set(_data 0)
+set(_bss 0)
+if(_sections MATCHES "\n\\.data[ \t]+([0-9]+)")
+    set(_data ${CMAKE_MATCH_1})
+endif()
+if(_sections MATCHES "\n\\.bss[ \t]+([0-9]+)")
+    set(_bss ${CMAKE_MATCH_1})
+endif()
+
+# Flash-resident constants, from the memory map part of the linker map (not the discarded sections)
+set(_flash 0)
+file(READ ${MAP} _map)
+string(FIND "${_map}" "Linker script and memory map" _start)
+if(_start GREATER_EQUAL 0)
+    string(SUBSTRING "${_map}" ${_start} -1 _map)
+    string(REGEX MATCHALL "\\.progmem\\.data[^ \t\n]*[ \t\n]+0x[0-9a-fA-F]+[ \t]+0x[0-9a-fA-F]+" _inputs "${_map}")
+    foreach(_input IN LISTS _inputs)
+        string(REGEX MATCH "0x([0-9a-fA-F]+)$" _ "${_input}")
+        math(EXPR _flash "${_flash} + 0x${CMAKE_MATCH_1}")
+    endforeach()
+endif()
+
+math(EXPR _used "${_data} + ${_bss}")
+message(STATUS "${NAME}: SRAM ${_used} of ${SRAM_SIZE} bytes (.data ${_data}, .bss ${_bss}), "
+               "${_flash} bytes of constants kept in flash")
+
+# RAM map: sizes of the data symbols grouped by their namespace, largest first
+execute_process(COMMAND ${NM} -S -C ${ELF} OUTPUT_VARIABLE _symbols RESULT_VARIABLE _result)
+if(NOT _result EQUAL 0)
+    return()
+endif()
+string(REPLACE "\n" ";" _symbols "${_symbols}")
+set(_modules "")
+foreach(_symbol IN LISTS _symbols)
+    if(NOT _symbol MATCHES "^[0-9a-fA-F]+ ([0-9a-fA-F]+) [bBdD] (.*)$")
+        continue()
+    endif()
+    set(_size_hex ${CMAKE_MATCH_1})
+    set(_name "${CMAKE_MATCH_2}")
+    if(_name MATCHES "^([A-Za-z_][A-Za-z0-9_]*)::")
+        set(_module ${CMAKE_MATCH_1})
+    else()
+        set(_module "(global)")
+    endif()
+    if(NOT DEFINED _ram_${_module})
+        set(_ram_${_module} 0)
+        list(APPEND _modules ${_module})
+    endif()
+    math(EXPR _ram_${_module} "${_ram_${_module}} + 0x${_size_hex}")
+endforeach()
+
+set(_sorted "")
+foreach(_module IN LISTS _modules)
+    string(LENGTH "${_ram_${_module}}" _digits)
+    math(EXPR _pad "6 - ${_digits}")
+    string(REPEAT "0" ${_pad} _zeros)
+    list(APPEND _sorted "${_zeros}${_ram_${_module}} ${_module}")
+endforeach()
+list(SORT _sorted ORDER DESCENDING)
+
+set(_map_text "")
+foreach(_entry IN LISTS _sorted)
+    string(REGEX MATCH "^0*([0-9]+) (.*)$" _ "${_entry}")
+    if(_map_text)
+        string(APPEND _map_text ", ")
+    endif()
+    string(APPEND _map_text "${CMAKE_MATCH_2} ${CMAKE_MATCH_1}")
+endforeach()
+message(STATUS "${NAME}: RAM map: ${_map_text}")
@@ -0,0 +1,55 @@
+#    This is a part of the Razmer2M project
+#    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+# Toolpath of the emulator (see include/toolpath.h and tools/gcode.h)
+# target_toolpath() builds razmer2m_gcode with the host compiler, as the firmware is cross compiled,
+# and runs it on a G-code program to generate toolpath_data.h for the target:
+#   /path/to/part.nc: 91462 frames (30:29), 1080 records, 6254 bytes (205 bytes per minute)
+# defs are the display definitions of the target, the toolpath is compiled for the same units.
+
+function(target_toolpath target program defs)
+    find_program(HOST_CXX NAMES c++ g++ clang++ REQUIRED)
+    get_filename_component(_program ${program} ABSOLUTE BASE_DIR ${CMAKE_SOURCE_DIR})
+    set(_dir ${CMAKE_CURRENT_BINARY_DIR}/${target}_toolpath)
+    set(_tool ${_dir}/${PROJECT_NAME}_gcode)
+    set(_header ${_dir}/toolpath_data.h)
+    set(_host_defs "")
+    foreach(_def IN LISTS defs)
+        list(APPEND _host_defs -D${_def})
+    endforeach()
+
+    add_custom_command(
+        OUTPUT ${_tool}
+        COMMAND ${CMAKE_COMMAND} -E make_directory ${_dir}
+        COMMAND ${HOST_CXX} -std=c++17 -O2 ${_host_defs} -I${CMAKE_SOURCE_DIR}/include -I${CMAKE_SOURCE_DIR}/tools
+                -o ${_tool} ${CMAKE_SOURCE_DIR}/tools/gcode.cpp
+        DEPENDS ${CMAKE_SOURCE_DIR}/tools/gcode.cpp ${CMAKE_SOURCE_DIR}/tools/gcode.h
+                ${CMAKE_SOURCE_DIR}/include/toolpath.h
+        COMMENT "Host G-code compiler for ${target}"
+        VERBATIM
+    )
+    add_custom_command(
+        OUTPUT ${_header}
+        COMMAND ${_tool} -o ${_header} ${_program}
+        DEPENDS ${_tool} ${_program}
+        COMMENT "Toolpath of ${target} from ${program}"
+        VERBATIM
+    )
+    target_sources(${target} PRIVATE ${_header})
+    target_include_directories(${target} PRIVATE ${_dir})
+    target_compile_definitions(${target} PRIVATE EMULATOR_TOOLPATH)
+endfunction()
@@ -55,6 +55,7 @@ if(WIN32)
     set(CMAKE_OBJCOPY      "${AVR_TOOLCHAIN_ROOT}/bin/avr-objcopy.exe")
     set(CMAKE_OBJDUMP      "${AVR_TOOLCHAIN_ROOT}/bin/avr-objdump.exe")
     set(CMAKE_SIZE         "${AVR_TOOLCHAIN_ROOT}/bin/avr-size.exe")
+    set(CMAKE_NM           "${AVR_TOOLCHAIN_ROOT}/bin/avr-nm.exe")
 else()
     set(CMAKE_C_COMPILER   "${AVR_TOOLCHAIN_ROOT}/bin/avr-gcc")
     set(CMAKE_CXX_COMPILER "${AVR_TOOLCHAIN_ROOT}/bin/avr-g++")
@@ -64,6 +65,7 @@ else()
     set(CMAKE_OBJCOPY      "${AVR_TOOLCHAIN_ROOT}/bin/avr-objcopy")
     set(CMAKE_OBJDUMP      "${AVR_TOOLCHAIN_ROOT}/bin/avr-objdump")
     set(CMAKE_SIZE         "${AVR_TOOLCHAIN_ROOT}/bin/avr-size")
+    set(CMAKE_NM           "${AVR_TOOLCHAIN_ROOT}/bin/avr-nm")
 endif()
 
 # No standard system paths
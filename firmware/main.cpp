@@ -25,9 +25,16 @@
 #endif
 
 extern "C" int main() {
+#if LOAD_METER
+    load::calibrate();  // Before any interrupt can disturb it
+#endif
     sei();  // Enable global interrupts
     MODULE::init();
     while (true) {
         MODULE::update();
+#if LOAD_METER
+        load::update(uptime::now());
+        load::idle();
+#endif
     }
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <avr/io.h>
+
+#include "baud.h"
+#include "config.h"
+#include "irq.h"
+
+// Serial rate detection on the receiver
+// The shortest pulse on RX (PD0) is one bit time. Timer1 counts CPU cycles while the pin is polled,
+// like an input capture on the RX pin (ICP1 is on PB0, so the capture unit itself cannot see RX).
+// A width only counts once several pulses agree on it (see baud::bit_cycles), so a noise spike does
+// not pass for a bit. The bit time is snapped to the nearest usable rate in baud::RATES.
+namespace autobaud {
+
+// Edges to look at; data lines contain single bit pulses (spaces, digits) often enough
+constexpr uint8_t EDGES = 64;
+
+// Give up after about 2 seconds (Timer1 overflows every 65536 cycles)
+constexpr uint16_t TIMEOUT_OVERFLOWS = static_cast<uint16_t>(2 * F_CPU / 65536);
+
+// Confirmed bit time on RX in CPU cycles, 0 if the line stayed quiet or no width was confirmed
+// Timer1 is borrowed and given back, so this also runs after uptime::init(); the uptime clock
+// stands still meanwhile, as all interrupts are off.
+inline uint16_t bit_pulse() {
+    irq::critical_section lock;
+    const uint8_t control_a = TCCR1A;
+    const uint8_t control_b = TCCR1B;
+    const uint16_t count = TCNT1;
+
+    TCCR1A = 0;
+    TCCR1B = _BV(CS10);  // No prescaler: one count per cycle
+    TIFR1 = _BV(TOV1);
+
+    uint16_t widths[EDGES];
+    uint8_t level = PIND & _BV(PD0);
+    uint16_t start = TCNT1;
+    uint16_t overflows = 0;
+    bool long_pulse = true;  // The first pulse started before we looked
+    uint8_t edges = 0;
+
+    while (edges < EDGES) {
+        if ((PIND & _BV(PD0)) != level) {
+            uint16_t now = TCNT1;
+            level ^= _BV(PD0);
+            widths[edges++] = long_pulse ? 0 : static_cast<uint16_t>(now - start);
+            start = now;
+            long_pulse = false;
+        } else if (TIFR1 & _BV(TOV1)) {
+            // Pulses spanning a timer overflow are idle time, not bits
+            TIFR1 = _BV(TOV1);
+            long_pulse = true;
+            if (++overflows >= TIMEOUT_OVERFLOWS) break;
+        }
+    }
+
+    // Our own overflows must not reach the uptime clock
+    TCCR1B = 0;
+    TIFR1 = _BV(TOV1);
+    TCNT1 = count;
+    TCCR1A = control_a;
+    TCCR1B = control_b;
+    return edges < EDGES ? 0 : baud::bit_cycles(widths, edges);
+}
+
+// Detect the sender rate, `fallback` if nothing usable was seen
+inline baud::setting detect(const baud::setting& fallback) {
+    baud::setting setting = baud::nearest(F_CPU, bit_pulse());
+    return setting.valid ? setting : fallback;
+}
+
+}  // namespace autobaud
@@ -0,0 +1,135 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <stdint.h>
+
+#include "flash.h"
+
+// USART baud rate settings
+// The USART divides F_CPU by 16 (normal mode) or 8 (U2X mode) times UBRR + 1, so most rates are
+// only approximated. solve() picks the mode with the smallest error; rates off by more than
+// MAX_ERROR_BP are rejected, as the receiver would sample bits too far from their centre.
+namespace baud {
+
+// 2 %, in basis points (1/100 %)
+constexpr int32_t MAX_ERROR_BP = 200;
+
+struct setting {
+    uint32_t rate;     // Requested rate
+    uint16_t ubrr;     // UBRR0 value
+    bool u2x;          // Double speed mode (U2X0)
+    int32_t error_bp;  // Actual rate relative to the requested one, in basis points
+    bool valid;        // Within MAX_ERROR_BP
+};
+
+constexpr int32_t abs_bp(int32_t value) { return value < 0 ? -value : value; }
+
+// Error of one divider in basis points: actual / rate - 1 = f_cpu / (step * (UBRR + 1)) - 1
+constexpr int32_t divider_error_bp(uint32_t f_cpu, uint64_t step, uint64_t ubrr_plus_1) {
+    const int64_t generated = static_cast<int64_t>(step * ubrr_plus_1);
+    return static_cast<int32_t>((static_cast<int64_t>(f_cpu) - generated) * 10000 / generated);
+}
+
+// Closest divider in one mode: the one below or above the exact quotient
+constexpr setting candidate(uint32_t f_cpu, uint32_t rate, bool u2x) {
+    const uint64_t step = static_cast<uint64_t>(u2x ? 8 : 16) * rate;
+    uint64_t below = f_cpu / step;
+    if (below < 1) below = 1;
+    if (below > 4096) return {rate, 4095, u2x, INT32_MAX, false};
+    const uint64_t above = below < 4096 ? below + 1 : below;
+
+    const int32_t error_below = divider_error_bp(f_cpu, step, below);
+    const int32_t error_above = divider_error_bp(f_cpu, step, above);
+    const bool use_above = abs_bp(error_above) < abs_bp(error_below);
+    const int32_t error_bp = use_above ? error_above : error_below;
+    return {rate, static_cast<uint16_t>((use_above ? above : below) - 1), u2x, error_bp,
+            abs_bp(error_bp) <= MAX_ERROR_BP};
+}
+
+// Best setting for a rate
+// Normal mode wins ties: it samples every bit 16 times and tolerates more error than U2X.
+constexpr setting solve(uint32_t f_cpu, uint32_t rate) {
+    const setting normal = candidate(f_cpu, rate, false);
+    const setting u2x = candidate(f_cpu, rate, true);
+    return abs_bp(u2x.error_bp) < abs_bp(normal.error_bp) ? u2x : normal;
+}
+
+// Rates the receiver can detect, the usable ones depend on F_CPU (in flash)
+constexpr uint32_t RATES[] PROGMEM = {2400, 4800, 9600, 19200, 38400, 57600, 76800, 115200, 230400, 250000, 500000, 1000000};
+constexpr uint8_t RATE_COUNT = sizeof(RATES) / sizeof(RATES[0]);
+
+// Highest rate of RATES that can be generated from f_cpu, 0 if none
+constexpr uint32_t fastest(uint32_t f_cpu) {
+    uint32_t best = 0;
+    for (uint8_t i = 0; i < RATE_COUNT; i++) {
+        if (solve(f_cpu, RATES[i]).valid) best = RATES[i];
+    }
+    return best;
+}
+
+// Usable rate closest to a measured bit time, by ratio
+// Returns an invalid setting if no rate is usable at this F_CPU or the bit time is 0
+inline setting nearest(uint32_t f_cpu, uint32_t bit_cycles) {
+    setting best{0, 0, false, INT32_MAX, false};
+    if (bit_cycles == 0) return best;
+    uint32_t best_ratio = UINT32_MAX;
+    for (uint8_t i = 0; i < RATE_COUNT; i++) {
+        const uint32_t rate = flash::read(&RATES[i]);
+        const setting s = solve(f_cpu, rate);
+        if (!s.valid) continue;
+        // Ratio of the longer to the shorter bit time, times 256
+        const uint32_t cycles = f_cpu / rate;
+        const uint32_t ratio = cycles > bit_cycles ? static_cast<uint32_t>(static_cast<uint64_t>(cycles) * 256 / bit_cycles)
+                                                   : static_cast<uint32_t>(static_cast<uint64_t>(bit_cycles) * 256 / cycles);
+        if (ratio < best_ratio) {
+            best_ratio = ratio;
+            best = s;
+        }
+    }
+    return best;
+}
+
+// Pulses that must agree on a width before it is taken as the bit time, so a noise spike is not
+constexpr uint8_t CONFIRM = 4;
+
+// Measurement jitter of a pulse width in CPU cycles (the polling loop in autobaud.h)
+constexpr uint16_t JITTER_CYCLES = 8;
+
+// Bit time from the widths of the pulses seen on the line, in CPU cycles
+// The shortest width that at least CONFIRM widths match (up to an eighth plus JITTER_CYCLES
+// longer) is the one bit pulse; the mean of its group is returned, 0 if no width is confirmed.
+inline uint16_t bit_cycles(const uint16_t* widths, uint8_t count) {
+    uint16_t shortest = 0;
+    uint16_t mean = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        const uint16_t width = widths[i];
+        if (width == 0 || (shortest != 0 && width >= shortest)) continue;
+        const uint16_t tolerance = static_cast<uint16_t>(width / 8 + JITTER_CYCLES);
+        uint8_t matches = 0;
+        uint32_t sum = 0;
+        for (uint8_t j = 0; j < count; j++) {
+            if (widths[j] < width || widths[j] - width > tolerance) continue;
+            matches++;
+            sum += widths[j];
+        }
+        if (matches < CONFIRM) continue;
+        shortest = width;
+        mean = static_cast<uint16_t>(sum / matches);
+    }
+    return mean;
+}
+
+}  // namespace baud
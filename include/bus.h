@@ -0,0 +1,283 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stdint.h>
+
+#include "config.h"
+
+// Model of the Razmer 2M indicator bus, shared by the emulator (encoder),
+// the transmitter (decoder) and the host tools. It works on raw port images,
+// so the firmware can feed PIND/PINC directly.
+//
+// Lines (see gpio.h):
+//   - W1, W2, W4, W8 (PD2..PD5): BCD code of the current slot
+//   - ER (PD6), A7 (PD7): NCU status, sampled at the end of every frame
+//   - B0..B5 (PC0..PC5): slot address, all ones (IDLE) between slots
+//
+// A slot address is axis * 8 + position. Position 0 carries the sign
+// (CODE_MINUS or CODE_BLANK), positions 1..DIGITS the digits, most significant first.
+// The NCU scans the slots of all axes in order, followed by an idle gap:
+//
+//   W     ==X=== code 0 ===X=== code 1 ===X===
+//   B     ====IDLE====X=slot 0=X====IDLE====X=slot 1=X===
+//             setup       strobe    hold
+//
+// The code must be stable for the whole strobe. A slot is accepted when the address returns
+// to IDLE and the code is the same as at the start of the strobe.
+namespace bus {
+
+// Port D: W1..W8 code, ER and A7 status
+constexpr uint8_t W_SHIFT = 2;
+constexpr uint8_t W_MASK = 0x0F << W_SHIFT;
+constexpr uint8_t ER_MASK = 1 << 6;
+constexpr uint8_t A7_MASK = 1 << 7;
+constexpr uint8_t STATUS_MASK = ER_MASK | A7_MASK;
+
+// Port C: B0..B5 address
+constexpr uint8_t B_MASK = 0x3F;
+constexpr uint8_t IDLE = B_MASK;
+
+// Codes on W1..W8 besides the BCD digits
+constexpr uint8_t CODE_MINUS = 0x0A;
+constexpr uint8_t CODE_BLANK = 0x0F;
+
+// Slot address on B0..B5
+constexpr uint8_t address(uint8_t axis, uint8_t position) { return static_cast<uint8_t>((axis << 3) | position); }
+
+// Field extraction from the port images
+constexpr uint8_t code_of(uint8_t pind) { return static_cast<uint8_t>((pind & W_MASK) >> W_SHIFT); }
+constexpr uint8_t address_of(uint8_t pinc) { return static_cast<uint8_t>(pinc & B_MASK); }
+constexpr uint8_t status_of(uint8_t pind) { return static_cast<uint8_t>(pind & STATUS_MASK); }
+
+// Port D image presenting a code with the given status
+constexpr uint8_t portd(uint8_t code, uint8_t status) {
+    return static_cast<uint8_t>(((code << W_SHIFT) & W_MASK) | (status & STATUS_MASK));
+}
+
+// One complete scan of the bus
+template <size_t AXIS_COUNT_T = AXIS_COUNT, int AXIS_DIGIT_COUNT_T = AXIS_DIGIT_COUNT>
+struct frame {
+    static constexpr uint8_t SLOTS_PER_AXIS = AXIS_DIGIT_COUNT_T + 1;
+    static constexpr uint8_t SLOTS = AXIS_COUNT_T * SLOTS_PER_AXIS;
+
+    uint8_t code[AXIS_COUNT_T][SLOTS_PER_AXIS];
+    uint8_t status;
+};
+
+static_assert(AXIS_COUNT <= 8 && AXIS_DIGIT_COUNT < 8, "Slot address does not fit in B0..B5");
+
+// Convert axis values to bus codes, values must be within MIN_AXIS..MAX_AXIS
+template <size_t AXIS_COUNT_T = AXIS_COUNT, int AXIS_DIGIT_COUNT_T = AXIS_DIGIT_COUNT>
+void encode(const int64_t (&axis)[AXIS_COUNT_T], frame<AXIS_COUNT_T, AXIS_DIGIT_COUNT_T>& out) {
+    for (uint8_t i = 0; i < AXIS_COUNT_T; i++) {
+        uint32_t value = static_cast<uint32_t>(axis[i] < 0 ? -axis[i] : axis[i]);
+        out.code[i][0] = axis[i] < 0 ? CODE_MINUS : CODE_BLANK;
+        for (uint8_t position = AXIS_DIGIT_COUNT_T; position > 0; position--) {
+            out.code[i][position] = static_cast<uint8_t>(value % 10);
+            value /= 10;
+        }
+    }
+}
+
+// Convert bus codes to axis values
+// Returns false if the frame contains an invalid code
+template <size_t AXIS_COUNT_T = AXIS_COUNT, int AXIS_DIGIT_COUNT_T = AXIS_DIGIT_COUNT>
+bool decode(const frame<AXIS_COUNT_T, AXIS_DIGIT_COUNT_T>& in, int64_t (&axis)[AXIS_COUNT_T]) {
+    for (uint8_t i = 0; i < AXIS_COUNT_T; i++) {
+        uint8_t sign = in.code[i][0];
+        if (sign != CODE_MINUS && sign != CODE_BLANK) return false;
+        uint32_t value = 0;
+        for (uint8_t position = 1; position <= AXIS_DIGIT_COUNT_T; position++) {
+            uint8_t digit = in.code[i][position];
+            if (digit > 9) return false;
+            value = value * 10 + digit;
+        }
+        axis[i] = sign == CODE_MINUS ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+    }
+    return true;
+}
+
+// Bus waveform generator, the emulator side of the decoder below
+// Call tick() at a fixed rate; it returns the port images to output on the next tick.
+// Every slot takes three ticks (setup, strobe, hold), each frame is followed by an idle gap.
+template <size_t AXIS_COUNT_T = AXIS_COUNT, int AXIS_DIGIT_COUNT_T = AXIS_DIGIT_COUNT>
+class scanner {
+   public:
+    using frame_t = frame<AXIS_COUNT_T, AXIS_DIGIT_COUNT_T>;
+
+    static constexpr uint8_t TICKS_PER_SLOT = 3;
+    static constexpr uint8_t GAP_TICKS = 4 * TICKS_PER_SLOT;
+    static constexpr uint16_t TICKS_PER_FRAME = frame_t::SLOTS * TICKS_PER_SLOT + GAP_TICKS;
+
+    // Frame to scan next, may be called at any time; takes effect at the next frame start
+    void load(const frame_t& next) { pending = next; }
+
+    // ER and A7 levels to output (ER_MASK, A7_MASK)
+    uint8_t status = 0;
+
+    // Replace the setup phase of every N-th slot by a one tick spike on one of the B lines (0 = off)
+    uint8_t glitch_interval = 0;
+
+    // Compute the port images for the next tick
+    // Returns true when the gap after a frame starts, which is a good moment to load() the next one
+    bool tick(uint8_t& portd, uint8_t& portc) {
+        bool frame_done = false;
+        switch (phase) {
+            case SETUP:
+                portc = address(axis, position);
+                phase = STROBE;
+                break;
+            case STROBE:
+                portc = IDLE;
+                phase = HOLD;
+                break;
+            case HOLD:
+                if (++position > AXIS_DIGIT_COUNT_T) {
+                    position = 0;
+                    if (++axis >= AXIS_COUNT_T) {
+                        axis = 0;
+                        gap = GAP_TICKS;
+                        phase = GAP;
+                        frame_done = true;
+                        break;
+                    }
+                }
+                setup(portd, portc);
+                break;
+            case GAP:
+                if (--gap == 0) {
+                    current = pending;
+                    setup(portd, portc);
+                }
+                break;
+        }
+        return frame_done;
+    }
+
+   private:
+    enum phase_t : uint8_t { SETUP, STROBE, HOLD, GAP };
+
+    void setup(uint8_t& portd, uint8_t& portc) {
+        portd = bus::portd(current.code[axis][position], status);
+        portc = IDLE;
+        if (glitch_interval != 0 && ++glitch_counter >= glitch_interval) {
+            glitch_counter = 0;
+            portc = static_cast<uint8_t>(IDLE & ~(1 << glitch_line));
+            if (++glitch_line >= 6) glitch_line = 0;
+        }
+        phase = SETUP;
+    }
+
+    frame_t current{};
+    frame_t pending{};
+    uint8_t axis = 0;
+    uint8_t position = 0;
+    uint8_t phase = GAP;
+    uint8_t gap = 1;
+    uint8_t glitch_counter = 0;
+    uint8_t glitch_line = 0;
+};
+
+// Bus decoder
+// Feed it the port images whenever B0..B5 (or any line, on the host) may have changed.
+// It tracks the expected slot, rejects glitches and reports complete frames.
+template <size_t AXIS_COUNT_T = AXIS_COUNT, int AXIS_DIGIT_COUNT_T = AXIS_DIGIT_COUNT>
+class decoder {
+   public:
+    using frame_t = frame<AXIS_COUNT_T, AXIS_DIGIT_COUNT_T>;
+
+    // Process one sample of both ports
+    // Returns true when the sample completed a frame, which is then available from last()
+    bool sample(uint8_t pind, uint8_t pinc) {
+        uint8_t addr = address_of(pinc);
+        uint8_t code = code_of(pind);
+
+        if (addr == active) {
+            // Code must not change during the strobe
+            if (addr != IDLE && code != latched) unstable = true;
+            return false;
+        }
+
+        bool completed = false;
+        if (active != IDLE) {
+            // End of strobe
+            if (addr != IDLE) {
+                // Address changed without returning to idle
+                glitch();
+            } else if (unstable || code != latched) {
+                glitch();
+            } else {
+                completed = accept(pind);
+            }
+        } else if (addr == address(0, 0)) {
+            // Start of frame, the previous one is lost if it was not complete
+            if (slot != 0 && slot != SYNC_LOST) glitch();
+            slot = 0;
+        } else if (slot != SYNC_LOST && addr != expected_address()) {
+            // Strobe of an unexpected slot: wait for the start of the next frame
+            glitch();
+        }
+
+        active = addr;
+        latched = code;
+        unstable = false;
+        return completed;
+    }
+
+    // Last complete frame
+    const frame_t& last() const { return complete; }
+
+    // Number of complete frames
+    uint16_t frames() const { return frame_count; }
+
+    // Number of rejected strobes (runt pulses, unstable codes, out of order slots)
+    uint16_t glitches() const { return glitch_count; }
+
+   private:
+    uint8_t expected_address() const {
+        return address(slot / frame_t::SLOTS_PER_AXIS, slot % frame_t::SLOTS_PER_AXIS);
+    }
+
+    void glitch() {
+        glitch_count++;
+        slot = SYNC_LOST;
+    }
+
+    bool accept(uint8_t pind) {
+        if (slot == SYNC_LOST) return false;
+        current.code[slot / frame_t::SLOTS_PER_AXIS][slot % frame_t::SLOTS_PER_AXIS] = latched;
+        if (++slot < frame_t::SLOTS) return false;
+        current.status = status_of(pind);
+        complete = current;
+        frame_count++;
+        slot = 0;
+        return true;
+    }
+
+    static constexpr uint8_t SYNC_LOST = 0xFF;
+
+    frame_t current{};
+    frame_t complete{};
+    uint8_t active = IDLE;
+    uint8_t latched = 0;
+    uint8_t slot = SYNC_LOST;
+    bool unstable = false;
+    uint16_t frame_count = 0;
+    uint16_t glitch_count = 0;
+};
+
+}  // namespace bus
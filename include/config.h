@@ -37,6 +37,50 @@
 #define BAUDRATE (38400)  // Default baud rate
 #endif
 
+#ifndef FRAME_RATE
+#define FRAME_RATE (50)  // Data lines per second on the serial link (emulator rate, receiver budget)
+#endif
+
+#ifndef BUS_SLOT_PERIOD_US
+#define BUS_SLOT_PERIOD_US (480)  // Emulated Razmer 2M bus: slot period (setup + strobe + hold)
+#endif
+
+#ifndef BUS_GLITCH_INTERVAL
+#define BUS_GLITCH_INTERVAL (0)  // Emulated Razmer 2M bus: inject a glitch every N slots (0 = off)
+#endif
+
+#ifndef BUS_STATUS_INVERT
+#define BUS_STATUS_INVERT (0x00)  // Transmitter: ER (0x40) and A7 (0x80) lines that are active low (bit mask)
+#endif
+
+#ifndef RAW_SAMPLE_PERIOD_US
+#define RAW_SAMPLE_PERIOD_US (16)  // Transmitter: bus sample period of the raw stream (see sampler.h)
+#endif
+
+#ifndef TOOLPATH_SPEED
+#define TOOLPATH_SPEED (1)  // Emulator: toolpath frames played per frame (1 = real time, see toolpath.h)
+#endif
+
+#ifndef LOAD_METER
+#define LOAD_METER (0)  // CPU load meter: interrupt, main loop and idle time on the link as "#c" lines (see load.h)
+#endif
+
+#ifndef LOAD_WINDOW
+#define LOAD_WINDOW (4)  // CPU load meter: seconds the reported shares are averaged over
+#endif
+
+#ifndef SPI_CALIBRATION
+#define SPI_CALIBRATION (1)  // Display: pick the SPI clock at boot through the DOUT loopback of the chain
+#endif
+
+#ifndef DIAMETER_AXES
+#define DIAMETER_AXES (0x01)  // Receiver: axes shown as diameter when the diameter jumper is set (bit mask)
+#endif
+
+#ifndef RECEIVER_LAYOUTS
+#define RECEIVER_LAYOUTS (0)  // Receiver: extra display layouts, as consecutive 3 digit codes (see layout.h)
+#endif
+
 // Compile-time configuration validation
 #if (AXIS_COUNT < 1) || (AXIS_COUNT > 5)
 #error "AXIS_COUNT must be between 1 and 5 inclusive"
@@ -50,6 +94,22 @@
 #error "AXIS_DOT_POSITION must be between 0 and AXIS_DIGIT_COUNT inclusive"
 #endif
 
+#if (FRAME_RATE < 8) || (FRAME_RATE > 2000) || (2000 % FRAME_RATE != 0)
+#error "FRAME_RATE must be between 8 and 2000 and divide the 2000 Hz timer rate"
+#endif
+
+#if (RAW_SAMPLE_PERIOD_US < 16) || (RAW_SAMPLE_PERIOD_US > 128)
+#error "RAW_SAMPLE_PERIOD_US must be between 16 and 128 inclusive"
+#endif
+
+#if (TOOLPATH_SPEED < 1) || (TOOLPATH_SPEED > 64)
+#error "TOOLPATH_SPEED must be between 1 and 64 inclusive"
+#endif
+
+#if (LOAD_WINDOW < 1) || (LOAD_WINDOW > 8)
+#error "LOAD_WINDOW must be between 1 and 8 inclusive"
+#endif
+
 typedef void (*callback_t)();
 
 constexpr int64_t kInt64Max = 9223372036854775807LL;
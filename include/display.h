@@ -16,19 +16,48 @@
 
 #pragma once
 #include <assert.h>
+#include <avr/eeprom.h>
 #include <avr/interrupt.h>
 #include <avr/io.h>
 #include <util/delay.h>
 
 #include "config.h"
+#include "flash.h"
 #include "gpio.h"
+#include "loopback.h"
+#include "segments.h"
 #include "spi.h"
+#include "uart.h"
 
 namespace display {
 
+// Paint budget
+// A full update is one SPI transfer of AXIS_COUNT * 2 bytes per column, plus one more that rewrites
+// a control register; the main loop sees the end of a transfer with up to 10 us delay
+// (spi::wait_until_done()).
+constexpr uint32_t COLUMNS = 8;
+constexpr uint32_t COLUMN_TIME_US = spi::transfer_time_ns(AXIS_COUNT * 2) / 1000 + 10;
+constexpr uint32_t PAINT_TIME_US = (COLUMNS + 1) * COLUMN_TIME_US;
+
+// Share of every frame spent painting at FRAME_RATE, in per mille
+constexpr uint32_t PAINT_LOAD_PERMILLE = PAINT_TIME_US * FRAME_RATE / 1000;
+
+// Highest frame rate the display can follow
+constexpr uint32_t MAX_PAINT_FRAME_RATE = 1000000 / PAINT_TIME_US;
+
+// Highest frame rate of the whole chain
+constexpr uint32_t MAX_FRAME_RATE =
+    MAX_PAINT_FRAME_RATE < uart::MAX_LINK_FRAME_RATE ? MAX_PAINT_FRAME_RATE : uart::MAX_LINK_FRAME_RATE;
+
+static_assert(PAINT_LOAD_PERMILLE <= 1000, "Display paint budget exceeded: lower FRAME_RATE or AXIS_COUNT");
+
 // Only receiver has display
 #if defined(RECEIVER) || defined(EMULATOR)
 
+// The functions below take the number of chips in the chain as CHIPS, AXIS_COUNT by default.
+// A receiver image with several layouts (see layout.h) instantiates them for each layout;
+// the buffers are sized for AXIS_COUNT, the largest chain.
+
 // Buffer for display content
 // Because screen updating is done column by column
 // addressing is done by column first
@@ -37,62 +66,21 @@ uint16_t buffer[8][AXIS_COUNT];
 // Transmission buffer for SPI
 volatile uint8_t tx_buffer[AXIS_COUNT * 2];
 
-// Convert ASCII character to segment representation
-uint8_t segment_from_ascii(char c) {
-    switch (c) {
-        case '0':
-            return 0x7E;  // 0
-        case '1':
-            return 0x30;  // 1
-        case '2':
-            return 0x6D;  // 2
-        case '3':
-            return 0x79;  // 3
-        case '4':
-            return 0x33;  // 4
-        case '5':
-            return 0x5B;  // 5
-        case '6':
-            return 0x5F;  // 6
-        case '7':
-            return 0x70;  // 7
-        case '8':
-            return 0x7F;  // 8
-        case '9':
-            return 0x7B;  // 9
-        case 'a':
-        case 'A':
-            return 0x77;  // A
-        case 'b':
-        case 'B':
-            return 0x1F;  // B
-        case 'c':
-        case 'C':
-            return 0x4E;  // C
-        case 'd':
-        case 'D':
-            return 0x3D;  // D
-        case 'e':
-        case 'E':
-            return 0x4F;  // E
-        case 'f':
-        case 'F':
-            return 0x47;  // F
-        case 'r':
-        case 'R':
-            return 0x05;  // R
-        case 'o':
-        case 'O':
-            return 0x1D;  // O
-        case '-':
-            return 0x01;  // Minus
-        case '.':
-        case ',':
-            return 0x80;  // Dot
-        default:
-            return 0x00;  // Blank for unsupported characters and spaces
-    }
-}
+// MAX7219 control registers
+// Noise on the lines can latch garbage into them, and only a rewrite recovers the chip. Every display
+// update ends with one more transfer that rewrites one of them from the shadow below, in turn, so
+// every chip is repaired within CONTROL_COUNT updates (0.1 s at 50 Hz).
+enum control_t : uint8_t { DECODE_MODE, INTENSITY, SCAN_LIMIT, SHUTDOWN, DISPLAY_TEST, CONTROL_COUNT };
+const uint8_t CONTROL_ADDRESS[CONTROL_COUNT] PROGMEM = {0x09, 0x0A, 0x0B, 0x0C, 0x0F};
+
+// Register values of every chip
+uint8_t control[AXIS_COUNT][CONTROL_COUNT];
+
+// Next register to rewrite
+uint8_t next_control = 0;
+
+// Completed rounds over all control registers
+uint16_t refresh_cycles = 0;
 
 // Clear transmission buffer
 inline void clear_tx_buffer() {
@@ -120,65 +108,118 @@ void send_command(const uint8_t addr, const uint8_t data, const uint8_t device)
     _delay_us(10);  // Small delay to allow the display to process the command
 }
 
-inline void init() {
+// Fill the transmission buffer with one control register for every chip
+template <uint8_t CHIPS = AXIS_COUNT>
+void load_control(const uint8_t reg) {
+    const uint8_t addr = flash::read(&CONTROL_ADDRESS[reg]);
+    for (uint8_t i = 0; i < CHIPS; i++) {
+        tx_buffer[i * 2] = addr;
+        tx_buffer[i * 2 + 1] = control[i][reg];
+    }
+}
+
+// Set a control register of one chip; it is written by the next refresh of that register
+inline void set_control(const uint8_t device, const control_t reg, const uint8_t value) {
+    control[device][reg] = value;
+}
+
+// Pick the SPI clock through the DOUT loopback of the chain (see loopback.h)
+// A calibrated rate is stored in EEPROM; a chain without the loopback runs at the stored rate, if any.
+template <uint8_t CHIPS = AXIS_COUNT>
+void calibrate() {
+    constexpr uint8_t FIRST = loopback::fastest(F_CPU);
+    uint8_t* const address = reinterpret_cast<uint8_t*>(loopback::EEPROM_ADDRESS);
+    const uint8_t calibrated = loopback::calibrate<CHIPS>(FIRST, spi::shift);
+    if (calibrated != loopback::NONE) eeprom_update_byte(address, calibrated);
+    spi::set_rate(loopback::select(calibrated, eeprom_read_byte(address), FIRST));
+}
+
+template <uint8_t CHIPS = AXIS_COUNT>
+void init() {
     // Initialize SPI
     spi::init();
+#if SPI_CALIBRATION
+    calibrate<CHIPS>();
+#endif
 
     // Initialize MAX7219
-    send_command(0x09, 0x00);  // Decode mode: no decode for all digits
-    send_command(0x0A, 0x00);  // Intensity: 1/32 (max)
-    send_command(0x0B, 0x07);  // Scan limit: all 8 digits
-    send_command(0x0C, 0x01);  // Shutdown register: normal operation
-    send_command(0x0F, 0x00);  // Display test: off
+    for (uint8_t i = 0; i < CHIPS; i++) {
+        control[i][DECODE_MODE] = 0x00;   // Decode mode: no decode for all digits
+        control[i][INTENSITY] = 0x00;     // Intensity: 1/32 (max)
+        control[i][SCAN_LIMIT] = 0x07;    // Scan limit: all 8 digits
+        control[i][SHUTDOWN] = 0x01;      // Shutdown register: normal operation
+        control[i][DISPLAY_TEST] = 0x00;  // Display test: off
+    }
+    for (uint8_t reg = 0; reg < CONTROL_COUNT; reg++) {
+        load_control<CHIPS>(reg);
+        spi::transmit<CHIPS * 2>(tx_buffer);
+        spi::wait_until_done();
+        _delay_us(10);  // Small delay to allow the display to process the command
+    }
 }
 
 // Current column being updated (1-8)
 uint8_t current_column = 0;
 
 // Start display update sequence
+template <uint8_t CHIPS = AXIS_COUNT>
 void start_update() {
     // Wait until any previous transmission is done
     spi::wait_until_done();
     // Prepare buffer for first column across all devices
-    for (uint8_t i = 0; i < AXIS_COUNT; ++i) {
+    for (uint8_t i = 0; i < CHIPS; ++i) {
         tx_buffer[i * 2] = 8;                 // Address (1-8)
         tx_buffer[i * 2 + 1] = buffer[0][i];  // Data
     }
     // Start transmission
-    spi::transmit<sizeof(tx_buffer)>(tx_buffer);
+    spi::transmit<CHIPS * 2>(tx_buffer);
     // Set to first column
     current_column = 1;
 }
 
 // Continue display update sequence
+template <uint8_t CHIPS = AXIS_COUNT>
 bool update() {
     // Skip if previous transmission is not done
     if (spi::is_busy()) return true;
-    // Stop if all columns have been updated
-    if (current_column > 7) return false;
+    // Stop if all columns and the control register have been updated
+    if (current_column > COLUMNS) return false;
     // Skip if first update not started
     if (current_column == 0) return false;
-    // Prepare buffer for this column across all devices & increment column
-    for (uint8_t i = 0; i < AXIS_COUNT; ++i) {
-        tx_buffer[i * 2 + 1] = buffer[current_column][i];  // Data
-        tx_buffer[i * 2] = 8 - current_column;             // Address (1-8)
+    if (current_column == COLUMNS) {
+        // After the last column: rewrite the next control register
+        load_control<CHIPS>(next_control);
+        if (++next_control >= CONTROL_COUNT) {
+            next_control = 0;
+            refresh_cycles++;
+        }
+    } else {
+        // Prepare buffer for this column across all devices
+        for (uint8_t i = 0; i < CHIPS; ++i) {
+            tx_buffer[i * 2 + 1] = buffer[current_column][i];  // Data
+            tx_buffer[i * 2] = 8 - current_column;             // Address (1-8)
+        }
     }
     current_column++;
     // Start transmission
-    spi::transmit<sizeof(tx_buffer)>(tx_buffer);
+    spi::transmit<CHIPS * 2>(tx_buffer);
 
     return true;
 }
 
-void write(const char* string) {
+// Write a message in the format() layout to the display buffer and start the update
+// The message ends at the terminating zero or newline; it is a string in RAM or a flash::string
+// Fields beyond the last chip are not shown
+template <uint8_t CHIPS = AXIS_COUNT, typename string_t>
+void write(string_t string) {
     uint8_t column = 0;
     uint8_t row = 0;
 
-    while (*string) {
+    while (*string && *string != '\n') {
         // Axis separator
         if (*string == ':') {
+            if (++row >= CHIPS) break;
             column = 0;
-            row++;
             string++;
             continue;
         }
@@ -188,7 +229,7 @@ void write(const char* string) {
 
         // If next char is dot
         if (*string == '.') {
-            buffer[column][row] |= 0x80;  // Set the dot bit
+            buffer[column][row] |= segments::DOT;  // Set the dot bit
             string++;
         }
 
@@ -196,25 +237,26 @@ void write(const char* string) {
         column++;
 
         // Assert on overflow
-        assert(row < AXIS_COUNT);
+        assert(row < CHIPS);
         assert(column < 8);
     }
 
     // Start display update
-    start_update();
+    start_update<CHIPS>();
 }
 
 // Clear display buffer and update display
+template <uint8_t CHIPS = AXIS_COUNT>
 void clear() {
     for (uint8_t col = 0; col < 8; col++) {
-        for (uint8_t axis = 0; axis < AXIS_COUNT; axis++) {
+        for (uint8_t axis = 0; axis < CHIPS; axis++) {
             buffer[col][axis] = 0;
         }
     }
     // Start display update
-    start_update();
+    start_update<CHIPS>();
     // Complete update
-    while (update());
+    while (update<CHIPS>());
 }
 
 #endif
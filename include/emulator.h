@@ -20,135 +20,199 @@
 #include "display.h"
 #include "format.h"
 #include "gpio.h"
+#include "irq.h"
+#include "load.h"
+#include "pattern.h"
+#include "ram.h"
+#include "stamp.h"
 #include "timer.h"
+#include "toolpath.h"
 #include "uart.h"
+#include "uptime.h"
+#include "urgent.h"
+#include "waveform.h"
+
+#ifdef EMULATOR_TOOLPATH
+#include "toolpath_data.h"  // Generated by razmer2m_gcode from the EMULATOR_TOOLPATH program
+#endif
 
 #define MODULE emulator
 
 namespace emulator {
 
-enum class algorithm_t : uint8_t { RANDOM, INCREMENTING, DECREMENTING, COUNT };
+using pattern::algorithm_t;
+
+// Axis values of one frame
+struct axes_t {
+    int64_t value[AXIS_COUNT];
+};
+
+// Frame prepared by the main loop for the frame interrupt
+struct frame_t {
+    axes_t axes;
+    char msg[uart::MESSAGE_SIZE];  // Time stamp line followed by the data line
+};
 
 // Current algorithm
+#ifdef EMULATOR_TOOLPATH
+algorithm_t algorithm = algorithm_t::TOOLPATH;
+
+// Toolpath playback, TOOLPATH_SPEED frames of the program per frame, over and over
+toolpath::player<> toolpath_player(toolpath::DATA);
+#else
 algorithm_t algorithm = algorithm_t::RANDOM;
-volatile uint16_t frame_counter = 0;
+#endif
+pattern::generator<AXIS_COUNT, AXIS_DIGIT_COUNT> generator;
+irq::atomic<uint16_t> frame_counter = 0;
 volatile uint8_t sub_cycle_counter = 0;
-char* volatile msg = nullptr;
 
-// Axis values
-int64_t axis[AXIS_COUNT] = {0};
-int64_t next_axis[AXIS_COUNT] = {0};
+// Axis values currently sent, written by the frame interrupt
+irq::seqlock<axes_t> axis;
+
+// Next frame, prepared by the main loop
+irq::double_buffer<frame_t> next_frame;
+
+// Set by the frame interrupt when the next frame is needed
+irq::atomic<bool> axis_updated = false;
+
+// Clock sync line, sent once a second by the frame interrupt
+char sync_msg[stamp::LINE_SIZE + 1];
+uint16_t sync_counter = 0;
+
+// Memory line, written by the main loop every ram::PERIOD_SECONDS and sent by the frame interrupt
+// after a data line, once it fits
+char memory_msg[ram::LINE_SIZE];
+irq::atomic<bool> memory_ready = false;
+uint8_t memory_counter = 0;
 
-// Boolean flags
-volatile bool axis_updated = false;
-volatile bool axis_ready = false;
+#if LOAD_METER
+// Load report line, written by the main loop and sent by the frame interrupt after the data line
+char load_msg[load::LINE_SIZE];
+irq::atomic<bool> load_ready = false;
+#endif
+
+// Bus speed as a power of two multiple of the nominal rate (1x, 2x, 4x, 8x)
+uint8_t bus_speed = 0;
+constexpr uint8_t BUS_SPEED_COUNT = 4;
+
+// NCU error, raised for a second after every bus speed change, on the bus and on the link
+uint8_t status = 0;
+char status_msg[urgent::LINE_SIZE + 1];
+
+void set_status(uint8_t value) {
+    status = value;
+    waveform::set_status(urgent::pins_of(value));
+    *urgent::write(status_msg, value, uptime::now()) = '\0';
+    uart::transmitter::transmit_urgent(status_msg);
+}
 
 // Next algorithm
+// After a full cycle of algorithms, the bus is switched to the next speed
 void next_algorithm() {
-    uint8_t next_algorithm = static_cast<uint8_t>(algorithm) + 1;
-    if (next_algorithm >= static_cast<uint8_t>(algorithm_t::COUNT)) next_algorithm = 0;
-    algorithm = static_cast<algorithm_t>(next_algorithm);
+    algorithm = pattern::following(algorithm);
+    if (algorithm == algorithm_t::RANDOM) {
+        if (++bus_speed >= BUS_SPEED_COUNT) bus_speed = 0;
+        waveform::set_slot_period(BUS_SLOT_PERIOD_US >> bus_speed);
+        set_status(urgent::ER);
+    }
 }
 
-// Function must be called 50 times per second in interrupt routine
-void update_50_hz() {
-    // Emulate sending message from transmitter
-    uart::transmitter::transmit(msg);
+// Frame counters must reach their limits at the highest FRAME_RATE config.h allows
+static_assert(static_cast<decltype(sync_counter)>(FRAME_RATE) == FRAME_RATE, "sync_counter too narrow for FRAME_RATE");
+static_assert(FRAME_RATE * pattern::CYCLE_SECONDS <= UINT16_MAX, "frame_counter too narrow for FRAME_RATE");
+static_assert(2000 / FRAME_RATE <= UINT8_MAX, "sub_cycle_counter too narrow for FRAME_RATE");
 
-    // Update axis values
-    if (axis_ready) {
-        for (uint8_t i = 0; i < AXIS_COUNT; ++i) {
-            axis[i] = next_axis[i];
-        }
+// Function must be called FRAME_RATE times per second in interrupt routine
+void update_frame() {
+    // Emulate sending message from transmitter
+    if (next_frame.take()) {
+        // Update axis values
+        axis.store(next_frame.front().axes);
+    }
+    if (++sync_counter >= FRAME_RATE) {
+        sync_counter = 0;
+        *stamp::write(sync_msg, stamp::SYNC, uptime::now()) = '\0';
+        uart::transmitter::transmit(sync_msg);
     }
+    uart::transmitter::transmit(next_frame.front().msg);
+    if (memory_ready.load() && uart::transmitter::transmit_spare(memory_msg)) memory_ready.store(false);
+#if LOAD_METER
+    if (load_ready.load() && uart::transmitter::transmit_spare(load_msg)) load_ready.store(false);
+#endif
 
     // Mark axis as updated
-    axis_updated = true;
+    axis_updated.store(true);
 
     // Increment frame_counter
-    frame_counter++;
+    frame_counter.store(static_cast<uint16_t>(frame_counter.load() + 1));
 }
 
 // Function must be called 2000 times per second in interrupt routine
 void update_2000_hz() {
-    if (++sub_cycle_counter >= 5 * 8) {
+    if (++sub_cycle_counter >= 2000 / FRAME_RATE) {
         sub_cycle_counter = 0;
-        update_50_hz();
-    }
-}
-
-int64_t random_axis() {
-    // Combine multiple rand() calls to get better distribution
-    // rand() on AVR returns 0-32767, so we need multiple calls for larger ranges
-    uint64_t r = 0;
-    for (uint8_t i = 0; i < 8; i++) {  // 8 calls gives us 64 bits of randomness
-        r = (r << 8) | (rand() & 0xFF);
+        update_frame();
     }
-
-    // Scale to our desired range
-    uint64_t range = static_cast<uint64_t>(MAX_AXIS_ABS);
-    int64_t v = static_cast<int64_t>(r % range);
-
-    if (rand() & 0x01) v = -v;
-
-    return v;
 }
 
-uint8_t random_delay_counter = 0;
-
 // Slow function, must be called in main loop
 void update() {
     gpio::debug<1>(spi::is_busy() ? 1 : 0);
 
-    // When next_axis copied to axis we can prepare next_axis
-    if (axis_updated) {
+    // When the last frame was picked up we can prepare the next one
+    if (axis_updated.exchange(false)) {
+        const axes_t current = axis.load();
+        frame_t& frame = next_frame.back();
+        int64_t (&next_axis)[AXIS_COUNT] = frame.axes.value;
+
         // Update next_axis based on current algorithm
-        switch (algorithm) {
-            // Random algorithm
-            case algorithm_t::RANDOM:
-                if (random_delay_counter == 0) {
-                    for (uint8_t i = 0; i < AXIS_COUNT; ++i) next_axis[i] = random_axis();
-                }
-
-                if (++random_delay_counter >= 50) {
-                    random_delay_counter = 0;
-                }
-
-                break;
-
-            // Incrementing algorithm
-            case algorithm_t::INCREMENTING:
-                for (uint8_t i = 0; i < AXIS_COUNT; ++i) next_axis[i] = (axis[i] < MAX_AXIS) ? axis[i] + 1 : MAX_AXIS;
-                axis_ready = true;
-                break;
-
-            // Decrementing algorithm
-            case algorithm_t::DECREMENTING:
-                for (uint8_t i = 0; i < AXIS_COUNT; ++i) next_axis[i] = (axis[i] > MIN_AXIS) ? axis[i] - 1 : MIN_AXIS;
-                axis_ready = true;
-                break;
-
-            default:
-                break;
+        generator.next(algorithm, current.value, next_axis, FRAME_RATE, rand);
+
+#ifdef EMULATOR_TOOLPATH
+        // Toolpath, restarted when the program ends
+        if (algorithm == algorithm_t::TOOLPATH) {
+            for (uint8_t i = 0; i < TOOLPATH_SPEED; ++i) {
+                toolpath_player.step();
+                if (toolpath_player.finished()) toolpath_player.restart();
+            }
+            for (uint8_t i = 0; i < AXIS_COUNT; ++i) next_axis[i] = toolpath_player[i];
         }
+#endif
 
-        // Prepare the message for transmission
-        msg = format(next_axis);
+        // Prepare the message for transmission, stamped with the time the values go on the bus
+        char* line = stamp::write(frame.msg, stamp::TIME, uptime::now());
+        format(next_axis, line);
 
-        // Put message directly on display
-        display::write(msg);
+        // Hand the frame over to the frame interrupt
+        next_frame.publish();
+
+        // Put the same values on the Razmer 2M bus
+        bus::encode(next_axis, waveform::frames.back());
+        waveform::frames.publish();
 
-        // Reset axis_updated flag
-        axis_updated = false;
+        // Put message directly on display
+        display::write(line);
     }
 
-    // Change algorithm every 5 seconds
-    if (frame_counter >= 50 * 5) {
-        frame_counter = 0;
-        axis_ready = true;
-        next_algorithm();
+    if (status != 0 && frame_counter.load() >= FRAME_RATE) set_status(0);
+
+    // Change algorithm every pattern::CYCLE_SECONDS, report memory use every ram::PERIOD_SECONDS
+    // The toolpath plays on at the nominal bus speed
+    if (frame_counter.load() >= FRAME_RATE * pattern::CYCLE_SECONDS) {
+        frame_counter.store(0);
+        if (algorithm != algorithm_t::TOOLPATH) next_algorithm();
+        if (++memory_counter >= ram::PERIOD_SECONDS / pattern::CYCLE_SECONDS && !memory_ready.load()) {
+            memory_counter = 0;
+            ram::write(memory_msg);
+            memory_ready.store(true);
+        }
     }
 
+#if LOAD_METER
+    // Next line of a load report, once the previous one is gone
+    if (load::due() && !load_ready.load() && load::write(load_msg)) load_ready.store(true);
+#endif
+
     // Update display
     display::update();
 }
@@ -157,6 +221,8 @@ inline void init() {
     gpio::init();
     uart::transmitter::init();
     display::init();
+    waveform::init();
+    uptime::init();
     timer::init(update_2000_hz);
 }
 
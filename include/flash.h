@@ -0,0 +1,96 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#else
+// Host builds (tests, tools): flash is ordinary memory
+#define PROGMEM
+#define PSTR(s) (s)
+#define memcpy_P memcpy
+
+// Like the AVR version, the format string is not checked at compile time
+inline int sprintf_P(char* buffer, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vsprintf(buffer, format, args);
+    va_end(args);
+    return length;
+}
+#endif
+
+// Constant data in flash
+// On AVR, plain const data is copied to SRAM at startup. Tables and strings declared PROGMEM stay
+// in flash and must be read with flash::read() or through flash::ptr.
+namespace flash {
+
+// Read one object from flash
+template <typename T>
+inline T read(const T* address) {
+    T value;
+#if defined(__AVR__)
+    if constexpr (sizeof(T) == 1) {
+        const uint8_t byte = pgm_read_byte(address);
+        memcpy(&value, &byte, 1);
+    } else {
+        memcpy_P(&value, address, sizeof(T));
+    }
+#else
+    memcpy(&value, address, sizeof(T));
+#endif
+    return value;
+}
+
+// Pointer to data in flash, dereferencing reads flash
+template <typename T>
+class ptr {
+   public:
+    constexpr explicit ptr(const T* p) : address(p) {}
+
+    T operator*() const { return read(address); }
+    T operator[](size_t i) const { return read(address + i); }
+
+    ptr& operator++() {
+        ++address;
+        return *this;
+    }
+    ptr operator++(int) {
+        ptr previous = *this;
+        ++address;
+        return previous;
+    }
+    ptr operator+(size_t n) const { return ptr(address + n); }
+
+    const T* get() const { return address; }
+
+   private:
+    const T* address;
+};
+
+// Zero-terminated string in flash
+using string = ptr<char>;
+
+}  // namespace flash
+
+// String literal in flash, for functions taking a flash::string
+#define FLASH_STRING(s) (flash::string(PSTR(s)))
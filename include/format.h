@@ -19,30 +19,31 @@
 #include <stdio.h>
 
 #include "config.h"
+#include "flash.h"
 
 // Formats the emulated data into a string
 // The format is " 1234.56: -1234.56: 1234.56: -1234.56\n"
 // Each axis value is formatted with leading spaces and a dot at the correct position
+// (with AXIS_DOT_POSITION_T == 0 the field starts with the dot: "  -.123456")
+// Format strings are kept in flash (sprintf_P)
+// The caller provides the buffer, which must hold at least AXIS_COUNT_T * 10 + 1 characters
 template <size_t AXIS_COUNT_T = AXIS_COUNT, int AXIS_DIGIT_COUNT_T = AXIS_DIGIT_COUNT,
           int AXIS_DOT_POSITION_T = AXIS_DOT_POSITION>
-char* format(const int64_t (&axis)[AXIS_COUNT_T]) {
-    // Buffer to hold the formatted string
-    static char buffer[AXIS_COUNT_T * 10 + 1];
-
+char* format(const int64_t (&axis)[AXIS_COUNT_T], char* buffer) {
     // Compile-time calculation of format string components
     constexpr int integer_digits = AXIS_DOT_POSITION_T;
     constexpr int fractional_digits = AXIS_DIGIT_COUNT_T - AXIS_DOT_POSITION_T;
 
-    static const char plus_str[] = "        ";
-    static const char minus_str[] = "       -";
+    // Sign field: padding then '-' or a space, so every field is 10 characters with the dot
+    constexpr char sign_width = static_cast<char>('0' + 8 - AXIS_DIGIT_COUNT_T);
 
     // Compile-time divisor calculation
     constexpr auto calculate_divisor = []() constexpr {
-        int div = 1;
+        long div = 1;
         for (int j = 0; j < fractional_digits; j++) div *= 10;
         return div;
     };
-    constexpr int divisor = calculate_divisor();
+    constexpr long divisor = calculate_divisor();
 
     char* buffer_ptr = buffer;
 
@@ -50,33 +51,44 @@ char* format(const int64_t (&axis)[AXIS_COUNT_T]) {
     for (uint8_t i = 0; i < AXIS_COUNT_T; i++) {
         // Insert sign for negative values or space for positive values
         int64_t value = axis[i];
-        const char* sign = &plus_str[AXIS_DIGIT_COUNT_T];
+        char sign = ' ';
         if (value < 0) {
             value = -value;
-            sign = &minus_str[AXIS_DIGIT_COUNT_T];
+            sign = '-';
         }
 
-        // Calculate integer and fractional parts
-        int integer_part = value / divisor;
-        int fractional_part = value % divisor;
+        // Calculate integer and fractional parts (long: up to 7 digits do not fit an AVR int)
+        long integer_part = static_cast<long>(value / divisor);
+        long fractional_part = static_cast<long>(value % divisor);
 
-        // Format based on whether we have fractional digits
-        if constexpr (fractional_digits > 0) {
+        // Format based on whether we have integer and fractional digits
+        if constexpr (integer_digits == 0) {
+            // Build format string with the dot first
+            static const char format_str[] PROGMEM = {
+                '%', sign_width, 'c',                         // sign character + extra spaces
+                '.',                                          // decimal point
+                '%', '0', '0' + fractional_digits, 'l', 'd',  // zero-padded fractional part
+                ':',                                          // axis separator
+                '\0'};
+            buffer_ptr += sprintf_P(buffer_ptr, format_str, sign, fractional_part);
+        } else if constexpr (fractional_digits > 0) {
             // Build format string with decimal point and fractional part
-            constexpr char format_str[] = {'%', 's',                                // sign character + extra spaces
-                                           '%', '0', '0' + integer_digits,    'd',  // zero-padded integer part
-                                           '.',                                     // decimal point
-                                           '%', '0', '0' + fractional_digits, 'd',  // zero-padded fractional part
-                                           ':',                                     // axis separator
-                                           '\0'};
-            buffer_ptr += sprintf(buffer_ptr, format_str, sign, integer_part, fractional_part);
+            static const char format_str[] PROGMEM = {
+                '%', sign_width, 'c',                         // sign character + extra spaces
+                '%', '0', '0' + integer_digits,    'l', 'd',  // zero-padded integer part
+                '.',                                          // decimal point
+                '%', '0', '0' + fractional_digits, 'l', 'd',  // zero-padded fractional part
+                ':',                                          // axis separator
+                '\0'};
+            buffer_ptr += sprintf_P(buffer_ptr, format_str, sign, integer_part, fractional_part);
         } else {
             // Build format string without decimal point
-            constexpr char format_str[] = {'%', 's',                             // sign character + extra spaces
-                                           '%', '0', '0' + integer_digits, 'd',  // zero-padded integer part
-                                           ':',                                  // axis separator
-                                           '\0'};
-            buffer_ptr += sprintf(buffer_ptr, format_str, sign, integer_part);
+            static const char format_str[] PROGMEM = {
+                '%', sign_width, 'c',                      // sign character + extra spaces
+                '%', '0', '0' + integer_digits, 'l', 'd',  // zero-padded integer part
+                ':',                                       // axis separator
+                '\0'};
+            buffer_ptr += sprintf_P(buffer_ptr, format_str, sign, integer_part);
         }
     }
 
@@ -86,3 +98,65 @@ char* format(const int64_t (&axis)[AXIS_COUNT_T]) {
     // Return the formatted string
     return buffer;
 }
+
+// Same layout from 32-bit counts of at most AXIS_DIGIT_COUNT_T digits, as parse() returns them
+// Every digit comes from subtracting its power of ten, so there is no division and no sprintf_P:
+// at most 9 subtractions per digit. Larger magnitudes are shown as the largest value that fits,
+// all nines, rather than running the first digit past '9'.
+template <size_t AXIS_COUNT_T = AXIS_COUNT, int AXIS_DIGIT_COUNT_T = AXIS_DIGIT_COUNT,
+          int AXIS_DOT_POSITION_T = AXIS_DOT_POSITION>
+char* format(const int32_t (&axis)[AXIS_COUNT_T], char* buffer) {
+    static_assert(AXIS_DIGIT_COUNT_T >= 1 && AXIS_DIGIT_COUNT_T <= 7, "1 to 7 digits");
+    static const uint32_t powers[] PROGMEM = {1000000, 100000, 10000, 1000, 100, 10, 1};
+    constexpr uint8_t first = 7 - AXIS_DIGIT_COUNT_T;
+
+    // Largest magnitude of the layout
+    constexpr auto calculate_max = []() constexpr {
+        uint32_t max = 1;
+        for (int j = 0; j < AXIS_DIGIT_COUNT_T; j++) max *= 10;
+        return max - 1;
+    };
+    constexpr uint32_t max = calculate_max();
+
+    char* p = buffer;
+    for (uint8_t i = 0; i < AXIS_COUNT_T; i++) {
+        const int32_t value = axis[i];
+        char sign = ' ';
+        uint32_t rest = static_cast<uint32_t>(value);
+        if (value < 0) {
+            rest = 0u - rest;
+            sign = '-';
+        }
+        if (rest > max) rest = max;
+
+        // Padding, then the sign in the last place before the digits
+        for (uint8_t j = AXIS_DIGIT_COUNT_T; j < 7; j++) *p++ = ' ';
+        *p++ = sign;
+
+        for (uint8_t j = 0; j < AXIS_DIGIT_COUNT_T; j++) {
+            if (j == AXIS_DOT_POSITION_T) *p++ = '.';
+            const uint32_t power = flash::read(&powers[first + j]);
+            char digit = '0';
+            while (rest >= power) {
+                rest -= power;
+                digit++;
+            }
+            *p++ = digit;
+        }
+        *p++ = ':';
+    }
+
+    // Replace last colon with newline
+    *(p - 1) = '\n';
+    *p = '\0';
+    return buffer;
+}
+
+// Same as above, but formats into a static buffer shared by all callers
+template <size_t AXIS_COUNT_T = AXIS_COUNT, int AXIS_DIGIT_COUNT_T = AXIS_DIGIT_COUNT,
+          int AXIS_DOT_POSITION_T = AXIS_DOT_POSITION>
+char* format(const int64_t (&axis)[AXIS_COUNT_T]) {
+    // Buffer to hold the formatted string
+    static char buffer[AXIS_COUNT_T * 10 + 1];
+    return format<AXIS_COUNT_T, AXIS_DIGIT_COUNT_T, AXIS_DOT_POSITION_T>(axis, buffer);
+}
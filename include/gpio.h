@@ -16,6 +16,7 @@
 
 #pragma once
 #include <avr/io.h>
+#include <util/delay.h>
 
 namespace gpio {
 
@@ -54,14 +55,19 @@ namespace gpio {
 //       - PC6: reset by hardware
 //       - PB0..PB1: output
 //     for emulator:
-//       - PD2..PD7: output
-//       - PC0..PC5: output
+//       - PD2..PD7: output, driven by Timer2 (see waveform.h)
+//       - PC0..PC5: output, driven by Timer2 (see waveform.h)
 //     for transmitter:
-//       - PD2..PD7: input
-//       - PC0..PC5: input
+//       - PD0: serial RX with pull-up, raw stream command (see sampler.h)
+//       - PD2..PD5: input
+//       - PD6..PD7: input, pin change interrupt (ER, A7 status, see transmitter.h)
+//       - PC0..PC5: input, pin change interrupt (see transmitter.h)
 //     for receiver:
-//       - PD2..PD7: not used
-//       - PC0..PC5: not used
+//       - PD2: input with pull-up, inch jumper (to GND: show inches)
+//       - PD3: input with pull-up, diameter jumper (to GND: show DIAMETER_AXES as diameter)
+//       - PD4..PD7: not used
+//       - PC0..PC2: input with pull-up, layout jumpers (to GND: bit set, see layout.h)
+//       - PC3..PC5: not used
 
 // Initialize GPIO pins based on mode
 void init() {
@@ -74,7 +80,28 @@ void init() {
     // Set PC0..PC5 as output
     DDRC = (1 << PC0) | (1 << PC1) | (1 << PC2) | (1 << PC3) | (1 << PC4) | (1 << PC5);
 #endif
+
+#ifdef RECEIVER
+    // Pull-ups for the unit jumpers on PD2, PD3
+    PORTD |= static_cast<uint8_t>((1 << PD2) | (1 << PD3));
+    // Pull-ups for the layout jumpers on PC0..PC2
+    PORTC |= static_cast<uint8_t>((1 << PC0) | (1 << PC1) | (1 << PC2));
+#endif
+}
+
+#ifdef RECEIVER
+// Unit jumpers, read at every frame so they can be changed while running
+inline bool inch_jumper() { return !(PIND & (1 << PD2)); }
+inline bool diameter_jumper() { return !(PIND & (1 << PD3)); }
+
+// Layout jumpers, read once at boot: PC0 is bit 0
+// The pull-ups are switched on by init() just before; an open pin and its wiring need a moment to
+// charge, or it reads as a jumper to GND and the wrong layout runs until the next reset.
+inline uint8_t layout_jumpers() {
+    _delay_us(10);
+    return static_cast<uint8_t>(~PINC & ((1 << PC0) | (1 << PC1) | (1 << PC2)));
 }
+#endif
 
 // Set debug pin 0
 template <uint8_t pin>
@@ -0,0 +1,78 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <stdint.h>
+
+// Histograms with power of two buckets
+// Bucket 0 counts zeros, bucket k counts values in [2^(k-1), 2^k), the last bucket everything above.
+// Adding a value is a handful of byte compares and a saturating 16 bit increment.
+namespace histogram {
+
+// Bit length of a value: 0 for 0, 1 + floor(log2(value)) otherwise
+inline uint8_t bucket(uint32_t value) {
+    uint8_t base;
+    uint8_t byte;
+    if (value >> 16) {
+        if (value >> 24) {
+            base = 24;
+            byte = static_cast<uint8_t>(value >> 24);
+        } else {
+            base = 16;
+            byte = static_cast<uint8_t>(value >> 16);
+        }
+    } else if (value >> 8) {
+        base = 8;
+        byte = static_cast<uint8_t>(value >> 8);
+    } else {
+        base = 0;
+        byte = static_cast<uint8_t>(value);
+    }
+    if (byte >= 16) {
+        base += 4;
+        byte >>= 4;
+    }
+    if (byte >= 4) {
+        base += 2;
+        byte >>= 2;
+    }
+    if (byte >= 2) {
+        base += 1;
+        byte >>= 1;
+    }
+    return static_cast<uint8_t>(base + byte);
+}
+
+template <uint8_t BUCKETS>
+struct log2 {
+    static_assert(BUCKETS >= 2 && BUCKETS <= 33, "A 32 bit value has 33 buckets at most");
+
+    uint16_t count[BUCKETS] = {};
+
+    void add(uint32_t value) {
+        uint8_t i = bucket(value);
+        if (i >= BUCKETS) i = BUCKETS - 1;
+        if (count[i] != UINT16_MAX) count[i]++;
+    }
+
+    void clear() {
+        for (auto& c : count) c = 0;
+    }
+
+    // Smallest value counted in a bucket
+    static constexpr uint32_t lower_bound(uint8_t i) { return i == 0 ? 0 : static_cast<uint32_t>(1) << (i - 1); }
+};
+
+}  // namespace histogram
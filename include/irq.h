@@ -0,0 +1,307 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+#include <type_traits>
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#endif
+
+#include "config.h"
+
+// Synchronisation primitives shared between interrupt handlers and the main loop.
+//
+// The ATmega328P is a single core without nested interrupts, so the only concurrency is
+// "main loop preempted by ISR". Every primitive below states which side may call which
+// method; the rules are:
+//   - an ISR runs to completion, so anything the ISR does is atomic for the main loop;
+//   - the main loop can be interrupted between any two instructions unless the
+//     interrupts are masked with a critical_section;
+//   - single byte loads and stores are atomic, wider ones are not.
+//
+// On the host (native tests) there are no interrupts. Instead, irq::interrupt_point() is
+// called between the individual steps of every primitive and runs a user supplied
+// "ISR" callback there, unless a critical_section is active. This lets the tests
+// preempt the main-loop side at every place the real hardware could.
+namespace irq {
+
+// Compiler barrier: prevents reordering of memory accesses across this point
+inline void barrier() { __asm__ __volatile__("" ::: "memory"); }
+
+#if defined(__AVR__)
+
+// Masks interrupts for the lifetime of the object and restores the previous state
+class critical_section {
+   public:
+    critical_section() : sreg(SREG) { cli(); }
+    ~critical_section() { SREG = sreg; }
+
+    critical_section(const critical_section&) = delete;
+    critical_section& operator=(const critical_section&) = delete;
+
+   private:
+    uint8_t sreg;
+};
+
+// Interrupts happen for real on the target
+inline void interrupt_point() {}
+
+#else
+
+namespace host {
+
+// Simulated interrupt handler, called from interrupt_point()
+inline callback_t isr = nullptr;
+
+// True while interrupts are masked or the simulated handler is running
+inline bool masked = false;
+
+}  // namespace host
+
+// Run the simulated interrupt handler unless interrupts are masked
+inline void interrupt_point() {
+    if (host::masked || host::isr == nullptr) return;
+    host::masked = true;
+    host::isr();
+    host::masked = false;
+}
+
+// Masks simulated interrupts for the lifetime of the object
+class critical_section {
+   public:
+    critical_section() : saved(host::masked) { host::masked = true; }
+    ~critical_section() { host::masked = saved; }
+
+    critical_section(const critical_section&) = delete;
+    critical_section& operator=(const critical_section&) = delete;
+
+   private:
+    bool saved;
+};
+
+#endif
+
+namespace detail {
+
+// Copy an object that may be concurrently modified by the other side.
+// On the host the copy is done byte by byte with an interrupt point between the bytes,
+// which is exactly how a multi-byte copy can be torn on the AVR.
+template <typename T>
+inline void copy(T& dst, const T& src) {
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+#if defined(__AVR__)
+    memcpy(&dst, &src, sizeof(T));
+#else
+    auto d = reinterpret_cast<uint8_t*>(&dst);
+    auto s = reinterpret_cast<const uint8_t*>(&src);
+    for (size_t i = 0; i < sizeof(T); i++) {
+        interrupt_point();
+        d[i] = s[i];
+    }
+#endif
+}
+
+}  // namespace detail
+
+// Value shared between the main loop and ISRs, read and written as a whole.
+// Single byte values need no protection, wider ones are copied with interrupts masked.
+// Safe for any combination of readers and writers.
+template <typename T>
+class atomic {
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+   public:
+    constexpr atomic() : value() {}
+    constexpr atomic(T initial) : value(initial) {}
+
+    T load() const {
+        T result;
+        if constexpr (sizeof(T) == 1) {
+            barrier();
+            result = value;
+            barrier();
+        } else {
+            critical_section lock;
+            detail::copy(result, value);
+        }
+        return result;
+    }
+
+    void store(const T& desired) {
+        if constexpr (sizeof(T) == 1) {
+            barrier();
+            value = desired;
+            barrier();
+        } else {
+            critical_section lock;
+            detail::copy(value, desired);
+        }
+    }
+
+    // Replace the value and return the previous one
+    T exchange(const T& desired) {
+        critical_section lock;
+        T previous = value;
+        value = desired;
+        return previous;
+    }
+
+    operator T() const { return load(); }
+    atomic& operator=(const T& desired) {
+        store(desired);
+        return *this;
+    }
+
+   private:
+    T value;
+};
+
+// Single producer, single consumer ring buffer.
+// The producer and the consumer may each be either the main loop or an ISR,
+// but there must be only one of each. No critical sections are needed: each side
+// owns one of the 8-bit indices and only reads the other one.
+// Capacity must be a power of two not greater than 128.
+template <typename T, uint8_t CAPACITY>
+class ring_buffer {
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+    static_assert(CAPACITY <= 128, "CAPACITY must not exceed 128");
+
+   public:
+    static constexpr uint8_t capacity() { return CAPACITY; }
+
+    // Producer side: append a value, returns false if the buffer is full
+    bool push(const T& item) {
+        uint8_t h = head;
+        interrupt_point();
+        if (static_cast<uint8_t>(h - tail) >= CAPACITY) return false;
+        data[h & MASK] = item;
+        barrier();
+        interrupt_point();
+        head = static_cast<uint8_t>(h + 1);
+        return true;
+    }
+
+    // Producer side: number of values that can be pushed without failing
+    uint8_t space() const { return static_cast<uint8_t>(CAPACITY - size()); }
+
+    // Consumer side: remove the oldest value, returns false if the buffer is empty
+    bool pop(T& item) {
+        uint8_t t = tail;
+        interrupt_point();
+        if (head == t) return false;
+        item = data[t & MASK];
+        barrier();
+        interrupt_point();
+        tail = static_cast<uint8_t>(t + 1);
+        return true;
+    }
+
+    // Consumer side: drop all buffered values
+    void clear() { tail = head; }
+
+    // Either side: number of buffered values (a snapshot, may change immediately)
+    uint8_t size() const { return static_cast<uint8_t>(head - tail); }
+    bool empty() const { return head == tail; }
+
+   private:
+    static constexpr uint8_t MASK = CAPACITY - 1;
+
+    T data[CAPACITY]{};
+    volatile uint8_t head = 0;  // Written by the producer only
+    volatile uint8_t tail = 0;  // Written by the consumer only
+};
+
+// Sequence lock for multi-byte snapshots written by an ISR and read by the main loop.
+// The writer never waits; the reader retries until it gets a copy that was not
+// interrupted by a write. Must not be written from the main loop while an ISR reads it:
+// the ISR would spin forever on the odd sequence number.
+template <typename T>
+class seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+   public:
+    // Writer side (ISR)
+    void store(const T& item) {
+        sequence = static_cast<uint8_t>(sequence + 1);
+        barrier();
+        detail::copy(value, item);
+        barrier();
+        sequence = static_cast<uint8_t>(sequence + 1);
+    }
+
+    // Reader side (main loop)
+    T load() const {
+        T result;
+        uint8_t before;
+        do {
+            before = sequence;
+            barrier();
+            detail::copy(result, value);
+            barrier();
+        } while ((before & 1) || before != sequence);
+        return result;
+    }
+
+    // Number of completed writes modulo 128, can be used to detect new data
+    uint8_t version() const { return static_cast<uint8_t>(sequence >> 1); }
+
+   private:
+    T value{};
+    volatile uint8_t sequence = 0;
+};
+
+// Double buffer for data produced by the main loop and consumed by an ISR.
+// The main loop fills back() at its own pace and calls publish(); the ISR always sees a
+// complete front() buffer. The ISR cannot be preempted by the main loop, so the buffer
+// it reads is never modified under it. Not suitable for an ISR producer.
+template <typename T>
+class double_buffer {
+   public:
+    // Producer side (main loop): buffer to fill, not visible to the consumer
+    T& back() { return buffers[front_index ^ 1]; }
+
+    // Producer side (main loop): make back() the new front buffer
+    void publish() {
+        uint8_t next = static_cast<uint8_t>(front_index ^ 1);
+        barrier();
+        interrupt_point();
+        front_index = next;
+        interrupt_point();
+        fresh = true;
+    }
+
+    // Consumer side (ISR): most recently published buffer
+    const T& front() const { return buffers[front_index]; }
+
+    // Consumer side (ISR): returns true once per published buffer
+    bool take() {
+        if (!fresh) return false;
+        fresh = false;
+        return true;
+    }
+
+   private:
+    T buffers[2]{};
+    volatile uint8_t front_index = 0;
+    volatile bool fresh = false;
+};
+
+}  // namespace irq
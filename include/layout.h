@@ -0,0 +1,81 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stdint.h>
+
+#include "config.h"
+
+// Display layouts of one receiver image
+// A receiver image can drive panels of several layouts, each with its own render path compiled for it
+// (see receiver.h). A layout is written as the code axes * 100 + digits * 10 + dot position.
+// Layout 0 is the build layout (AXIS_COUNT, AXIS_DIGIT_COUNT, AXIS_DOT_POSITION); RECEIVER_LAYOUTS
+// lists the others as consecutive codes, e.g. 364274 for 3 axes of 6 digits with the dot at 4,
+// then 2 axes of 7 digits with the dot at 4. AXIS_COUNT is the largest number of axes: it sizes
+// the buffers of the image.
+namespace layout {
+
+constexpr uint16_t code(uint8_t axes, uint8_t digits, uint8_t dot) {
+    return static_cast<uint16_t>(axes * 100 + digits * 10 + dot);
+}
+constexpr uint8_t axes(uint16_t c) { return static_cast<uint8_t>(c / 100); }
+constexpr uint8_t digits(uint16_t c) { return static_cast<uint8_t>(c / 10 % 10); }
+constexpr uint8_t dot(uint16_t c) { return static_cast<uint8_t>(c % 10); }
+
+constexpr uint64_t EXTRA = RECEIVER_LAYOUTS;
+
+constexpr uint8_t count(uint64_t list) {
+    uint8_t n = 1;
+    for (; list != 0; list /= 1000) n++;
+    return n;
+}
+
+// Layouts in the image, and the most a 64 bit RECEIVER_LAYOUTS can hold
+constexpr uint8_t COUNT = count(EXTRA);
+constexpr uint8_t MAX_COUNT = 7;
+
+// Code of layout i
+constexpr uint16_t at(uint8_t i) {
+    if (i == 0) return code(AXIS_COUNT, AXIS_DIGIT_COUNT, AXIS_DOT_POSITION);
+    uint64_t list = EXTRA;
+    for (uint8_t k = i; k + 1 < COUNT; k++) list /= 1000;
+    return static_cast<uint16_t>(list % 1000);
+}
+
+constexpr bool valid(uint16_t c) {
+    return axes(c) >= 1 && axes(c) <= AXIS_COUNT && digits(c) >= 1 && digits(c) <= 7 && dot(c) <= digits(c);
+}
+
+constexpr bool all_valid() {
+    for (uint8_t i = 0; i < COUNT; i++) {
+        if (!valid(at(i))) return false;
+    }
+    return true;
+}
+
+static_assert(COUNT <= MAX_COUNT, "RECEIVER_LAYOUTS holds at most 6 layouts");
+static_assert(all_valid(), "RECEIVER_LAYOUTS: every layout needs 1..AXIS_COUNT axes, 1..7 digits and dot <= digits");
+
+// EEPROM byte with the layout index, 0xFF when erased
+constexpr uint16_t EEPROM_ADDRESS = 0;
+
+// Layout to use: the jumpers if any is set, else the EEPROM byte if it names a layout, else the build layout
+constexpr uint8_t select(uint8_t jumpers, uint8_t stored) {
+    if (jumpers != 0) return jumpers < COUNT ? jumpers : 0;
+    return stored < COUNT ? stored : 0;
+}
+
+}  // namespace layout
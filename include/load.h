@@ -0,0 +1,237 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__AVR__)
+#include <avr/io.h>
+#endif
+
+#include "config.h"
+#include "flash.h"
+#include "irq.h"
+
+// CPU load meter (LOAD_METER builds)
+// Every interrupt routine starts with a probe that adds its run time in Timer1 ticks (0.5 us) to
+// its source, plus ENTRY_TICKS for the part of the interrupt the probe cannot see. Between two
+// passes the main loop waits in idle() for the next interrupt, counting turns of a spin loop; the
+// time of a turn is measured at boot with interrupts off, so the idle time leaves out the
+// interrupts that hit the spin. What is left of the time is the main loop.
+// Slices of one second are kept for LOAD_WINDOW seconds, and every REPORT_SLICES slices the share
+// of every source in the window goes out as "#c<source> <per mille>" lines, one per main loop pass.
+// Without LOAD_METER the probes are empty and the main loop spins as before.
+namespace load {
+
+// Sources, in the order of the report
+enum source : uint8_t { MAIN, IDLE, TIMER0, TIMER1, TIMER2, USART_RX, USART_UDRE, SPI, PCINT1, PCINT2, COUNT };
+
+// Names in the report: main loop, idle, Timer0 (2 kHz), Timer1 overflow (uptime), Timer2 (waveform
+// or sampler), USART receive, USART data register empty, SPI, bus strobes, NCU status
+const char NAMES[] PROGMEM = {'m', 'i', 't', 'o', 'w', 'r', 'u', 's', 'b', 'e'};
+static_assert(sizeof(NAMES) == COUNT, "One name per source");
+
+// Report line "#c<name> <per mille>\n" and the terminating zero
+constexpr char TAG = 'c';
+constexpr size_t LINE_SIZE = 10;
+
+// Slices between two reports
+constexpr uint8_t REPORT_SLICES = 10;
+
+// Slices are kept in units of 64 ticks, so a slice of up to 4 seconds (at 16 MHz) fits 16 bits
+constexpr uint8_t UNIT_SHIFT = 6;
+
+// Busy time of every source over the last SLICES slices, and the report in progress
+template <uint8_t SLICES>
+class meter {
+    static_assert(SLICES >= 1 && SLICES <= 8, "1 to 8 slices");
+
+   public:
+    // Close a slice of `length` ticks; `busy` holds the ticks of the interrupts and of IDLE, MAIN gets
+    // the rest. Interrupts are taken first: their time is measured, the idle time is estimated.
+    void add(uint32_t length, const uint32_t (&busy)[COUNT]) {
+        uint16_t (&slice)[COUNT] = slices[next];
+        const uint16_t total = units(length);
+        uint16_t rest = total;
+        for (uint8_t s = TIMER0; s < COUNT; s++) slice[s] = take(busy[s], rest);
+        slice[IDLE] = take(busy[IDLE], rest);
+        slice[MAIN] = rest;
+        lengths[next] = total;
+        next = static_cast<uint8_t>((next + 1) % SLICES);
+        if (++since_report >= REPORT_SLICES) {
+            since_report = 0;
+            cursor = 0;
+        }
+    }
+
+    // Share of a source in the window, per mille
+    uint16_t permille(uint8_t s) const {
+        uint32_t busy = 0;
+        uint32_t total = 0;
+        for (uint8_t i = 0; i < SLICES; i++) {
+            busy += slices[i][s];
+            total += lengths[i];
+        }
+        return total == 0 ? 0 : static_cast<uint16_t>((busy * 1000 + total / 2) / total);
+    }
+
+    // True from the start of a report until its last line is written
+    bool due() const { return cursor < COUNT; }
+
+    // Write the next line of the report in progress, zero-terminated; false when there is none
+    // The main loop and idle are always reported, interrupts only if they ran in the window.
+    bool write(char* out) {
+        while (cursor < COUNT) {
+            const uint8_t s = cursor++;
+            if (s > IDLE && !ran(s)) continue;
+            sprintf_P(out, PSTR("#c%c %u\n"), flash::read(&NAMES[s]), permille(s));
+            return true;
+        }
+        return false;
+    }
+
+   private:
+    static uint16_t units(uint32_t ticks) {
+        ticks >>= UNIT_SHIFT;
+        return ticks > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(ticks);
+    }
+
+    // Units of `ticks`, at most what is left of the slice
+    static uint16_t take(uint32_t ticks, uint16_t& rest) {
+        uint16_t taken = units(ticks);
+        if (taken > rest) taken = rest;
+        rest = static_cast<uint16_t>(rest - taken);
+        return taken;
+    }
+
+    bool ran(uint8_t s) const {
+        for (uint8_t i = 0; i < SLICES; i++) {
+            if (slices[i][s] != 0) return true;
+        }
+        return false;
+    }
+
+    uint16_t slices[SLICES][COUNT] = {};
+    uint16_t lengths[SLICES] = {};
+    uint8_t next = 0;
+    uint8_t since_report = 0;
+    uint8_t cursor = COUNT;
+};
+
+#if LOAD_METER && defined(__AVR__)
+
+// Set by every probed interrupt, cleared by idle()
+volatile bool woken = false;
+
+// Ticks of every interrupt source since the start of the slice, written by the interrupts
+uint32_t busy[COUNT];
+
+// Cycles of an interrupt outside the two TCNT1 reads of its probe, counted on the worst case:
+//   response and vector jump                                                   7
+//   prologue and epilogue saving SREG, r0, r1 and 12 call-clobbered registers ~63
+//   adding to busy after the second read                                      ~22
+//   reti                                                                        4
+// Routines that save fewer registers are overcharged by a few cycles, rather than booking their
+// entry and exit to the main loop. Timer1 ticks are 8 cycles.
+constexpr uint8_t ENTRY_CYCLES = 96;
+constexpr uint8_t ENTRY_TICKS = (ENTRY_CYCLES + 4) / 8;
+
+// Adds the run time of an interrupt routine to its source: the first statement of the routine
+template <source S>
+class probe {
+   public:
+    probe() : start(TCNT1) {}
+    ~probe() {
+        busy[S] += static_cast<uint16_t>(TCNT1 - start + ENTRY_TICKS);
+        woken = true;
+    }
+
+   private:
+    uint16_t start;
+};
+
+// Slice length in uptime ticks
+constexpr uint32_t SLICE = F_CPU / 8;
+
+// Spin turns measured at boot, and the ticks they took
+constexpr uint16_t CALIBRATION_TURNS = 4096;
+uint16_t calibration = 0;
+
+// Idle turns and start of the current slice, main loop only
+uint32_t turns = 0;
+uint32_t slice_start = 0;
+
+meter<LOAD_WINDOW> window;
+
+// Count turns until an interrupt ran or `limit` is reached
+// Never inlined nor cloned, so the calibration times the very code idle() runs.
+__attribute__((noinline, noclone)) uint16_t spin(uint16_t limit) {
+    uint16_t n = 0;
+    while (!woken && n != limit) n++;
+    return n;
+}
+
+// Time the spin, before interrupts are enabled; Timer1 is set up as uptime::init() does it later
+inline void calibrate() {
+    TCCR1A = 0;
+    TCCR1B = _BV(CS11);
+    woken = false;
+    const uint16_t start = TCNT1;
+    spin(CALIBRATION_TURNS);
+    calibration = static_cast<uint16_t>(TCNT1 - start);
+}
+
+// Wait for the next interrupt, the main loop has nothing new to look at before it
+inline void idle() {
+    while (!woken) turns += spin(UINT16_MAX);
+    woken = false;
+}
+
+// Close the slice when it is over, called by the main loop with the uptime
+inline void update(uint32_t now) {
+    if (now - slice_start < SLICE) return;
+    uint32_t ticks[COUNT];
+    {
+        irq::critical_section lock;
+        memcpy(ticks, busy, sizeof(ticks));
+        memset(busy, 0, sizeof(busy));
+    }
+    // turns * calibration / CALIBRATION_TURNS without 64 bit arithmetic
+    ticks[IDLE] = ((turns >> 4) * calibration) >> 8;
+    turns = 0;
+    window.add(now - slice_start, ticks);
+    slice_start = now;
+}
+
+inline bool due() { return window.due(); }
+inline bool write(char* out) { return window.write(out); }
+
+#else
+
+template <source S>
+class probe {
+   public:
+    probe() {}
+};
+
+inline bool due() { return false; }
+inline bool write(char*) { return false; }
+
+#endif
+
+}  // namespace load
@@ -0,0 +1,139 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include "flash.h"
+
+// SPI clock calibration through the display chain
+// With the DOUT of the last MAX7219 wired back to MISO the chain is a shift register of 16 bits per chip:
+// bytes shifted in with CS low come back on MISO a fixed number of bits later. Nothing is latched as long as
+// every chip holds a no-op frame (address 0) when CS rises, so a test pattern followed by a tail of zero bytes
+// can be sent at any time. calibrate() finds the delay at the slowest clock, then tries faster clocks until
+// one garbles the pattern.
+namespace loopback {
+
+// Clocks F_CPU / 2 to F_CPU / 128, a rate is the shift of the divider: F_CPU / (2 << rate)
+constexpr uint8_t RATE_COUNT = 7;
+constexpr uint8_t SLOWEST = RATE_COUNT - 1;
+
+// No loopback: the pattern did not come back at the slowest clock
+constexpr uint8_t NONE = 0xFF;
+
+// Fastest clock of the MAX7219
+constexpr uint32_t MAX_CLOCK_HZ = 10000000;
+
+// EEPROM byte with the last calibrated rate, 0xFF when erased
+constexpr uint16_t EEPROM_ADDRESS = 1;
+
+constexpr uint32_t divider(uint8_t rate) { return 2ul << rate; }
+
+// Fastest rate the chips take at a CPU clock
+constexpr uint8_t fastest(uint32_t f_cpu) {
+    uint8_t rate = 0;
+    while (rate < SLOWEST && f_cpu / divider(rate) > MAX_CLOCK_HZ) rate++;
+    return rate;
+}
+
+// SPR1:SPR0 (SPCR) select F_CPU / 4, 16, 64 or 128, SPI2X (SPSR) halves the first three
+struct setting {
+    uint8_t spr;
+    bool spi2x;
+};
+
+constexpr setting control(uint8_t rate) {
+    return rate >= SLOWEST ? setting{3, false} : setting{static_cast<uint8_t>(rate >> 1), (rate & 1) == 0};
+}
+
+// Test pattern: both levels held for a byte, single bit runs and no two bytes alike,
+// so it matches at one delay only; odd rounds send it inverted
+const uint8_t PATTERN[] PROGMEM = {0xFF, 0x00, 0x55, 0xAA, 0xCC, 0x33, 0xB4, 0x2D};
+constexpr uint8_t PATTERN_SIZE = sizeof(PATTERN);
+
+// Rounds of the pattern a clock has to pass
+constexpr uint8_t ROUNDS = 8;
+
+// Zero bytes after the pattern: they push it out of a chain of CHIPS chips and leave no-op frames behind
+constexpr uint8_t tail(uint8_t chips) { return static_cast<uint8_t>(chips * 2 + 1); }
+
+// Bit of a buffer, most significant bit first as on the wire
+inline bool bit(const uint8_t* data, uint16_t index) { return (data[index >> 3] >> (7 - (index & 7))) & 1; }
+
+// Fill a transfer buffer of PATTERN_SIZE + tail() bytes
+inline void fill(uint8_t* tx, uint8_t size, bool inverted) {
+    for (uint8_t i = 0; i < size; i++) {
+        const uint8_t value = i < PATTERN_SIZE ? flash::read(&PATTERN[i]) : 0;
+        tx[i] = i < PATTERN_SIZE && inverted ? static_cast<uint8_t>(~value) : value;
+    }
+}
+
+// The bytes received hold the pattern sent, delayed by a number of bits
+inline bool matches(const uint8_t* tx, const uint8_t* rx, uint16_t delay) {
+    for (uint16_t i = 0; i < PATTERN_SIZE * 8; i++) {
+        if (bit(rx, static_cast<uint16_t>(i + delay)) != bit(tx, i)) return false;
+    }
+    return true;
+}
+
+// Smallest delay the pattern comes back with, up to max_delay bits, UINT16_MAX if none
+inline uint16_t find_delay(const uint8_t* tx, const uint8_t* rx, uint16_t max_delay) {
+    for (uint16_t delay = 0; delay <= max_delay; delay++) {
+        if (matches(tx, rx, delay)) return delay;
+    }
+    return UINT16_MAX;
+}
+
+// Fastest clean rate of the chain, from SLOWEST down to first, NONE without a loopback
+// shift(rate, tx, rx, size) exchanges size bytes at a rate with CS low for the whole transfer.
+// Every clock has to pass ROUNDS rounds at the delay seen at the slowest clock. If a clock fails, the fastest
+// clean one is too close to the edge and the next slower one is kept; if none fails the limit is the chips'
+// rating, not the wiring, and the fastest is kept.
+template <uint8_t CHIPS, typename shift_t>
+uint8_t calibrate(uint8_t first, shift_t shift) {
+    constexpr uint8_t SIZE = PATTERN_SIZE + tail(CHIPS);
+    uint8_t tx[SIZE], rx[SIZE];
+
+    fill(tx, SIZE, false);
+    shift(SLOWEST, tx, rx, SIZE);
+    const uint16_t delay = find_delay(tx, rx, tail(CHIPS) * 8);
+    if (delay == UINT16_MAX) return NONE;
+
+    uint8_t clean = NONE;
+    for (uint8_t rate = SLOWEST + 1; rate-- > first;) {
+        for (uint8_t round = 0; round < ROUNDS; round++) {
+            fill(tx, SIZE, round & 1);
+            shift(rate, tx, rx, SIZE);
+            if (!matches(tx, rx, delay)) {
+                if (clean == NONE) return NONE;  // Not even the slowest clock is reliable
+                return clean < SLOWEST ? static_cast<uint8_t>(clean + 1) : clean;
+            }
+        }
+        clean = rate;
+    }
+    return clean;
+}
+
+// Rate to use: the calibrated one if the loopback is wired, else the EEPROM byte if it names a rate the chips
+// take, else the slowest
+constexpr uint8_t select(uint8_t calibrated, uint8_t stored, uint8_t first) {
+    if (calibrated != NONE) return calibrated;
+    return stored >= first && stored <= SLOWEST ? stored : SLOWEST;
+}
+
+}  // namespace loopback
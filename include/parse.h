@@ -0,0 +1,63 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <stdint.h>
+
+#include "config.h"
+
+// Parse a data line produced by format() back into axis values
+// Each field is padding spaces, an optional '-', the integer digits, a '.' and exactly
+// AXIS_DIGIT_COUNT_T - AXIS_DOT_POSITION_T fractional digits; fields are separated by ':'.
+// The values are counts of the last digit, as passed to format(); a field has at most
+// AXIS_DIGIT_COUNT_T digits, so its value stays within units::MAX_MAGNITUDE.
+// Returns false if the line does not have this shape.
+template <size_t AXIS_COUNT_T = AXIS_COUNT, int AXIS_DIGIT_COUNT_T = AXIS_DIGIT_COUNT,
+          int AXIS_DOT_POSITION_T = AXIS_DOT_POSITION>
+bool parse(const char* line, int32_t (&axis)[AXIS_COUNT_T]) {
+    constexpr int8_t fractional_digits = AXIS_DIGIT_COUNT_T - AXIS_DOT_POSITION_T;
+
+    const char* p = line;
+    for (uint8_t i = 0; i < AXIS_COUNT_T; i++) {
+        while (*p == ' ') p++;
+        bool negative = *p == '-';
+        if (negative) p++;
+
+        int32_t value = 0;
+        int8_t digits = 0;
+        int8_t fraction = -1;  // Digits after the dot, -1 without a dot
+        for (;; p++) {
+            char c = *p;
+            if (c >= '0' && c <= '9') {
+                if (++digits > AXIS_DIGIT_COUNT_T) return false;  // More than format() writes
+                value = value * 10 + (c - '0');
+                if (fraction >= 0) fraction++;
+            } else if (c == '.' && fraction < 0) {
+                fraction = 0;
+            } else {
+                break;
+            }
+        }
+        if (digits == 0) return false;
+        if (fraction < 0) fraction = 0;
+        if (fraction != fractional_digits) return false;
+        axis[i] = negative ? -value : value;
+
+        // Separator, or the end of the line after the last field
+        char end = *p++;
+        if (static_cast<size_t>(i + 1) < AXIS_COUNT_T ? end != ':' : (end != '\0' && end != '\n')) return false;
+    }
+    return true;
+}
@@ -0,0 +1,107 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Emulator test patterns
+// Portable, so host tools (see tools/fleet.h) send the same values as the emulator firmware.
+namespace pattern {
+
+// Test patterns cycled every CYCLE_SECONDS, and the toolpath that replaces them when built in
+enum class algorithm_t : uint8_t { RANDOM, INCREMENTING, DECREMENTING, COUNT, TOOLPATH };
+
+constexpr uint8_t CYCLE_SECONDS = 5;
+
+// Pattern after a test pattern, RANDOM again after the last one
+constexpr algorithm_t following(algorithm_t algorithm) {
+    const uint8_t next = static_cast<uint8_t>(static_cast<uint8_t>(algorithm) + 1);
+    return next >= static_cast<uint8_t>(algorithm_t::COUNT) ? algorithm_t::RANDOM : static_cast<algorithm_t>(next);
+}
+
+// Largest value shown with a number of digits
+constexpr int64_t max_abs(int digits) {
+    int64_t max = 1;
+    for (int i = 0; i < digits; ++i) {
+        if (max > INT64_MAX / 10) return INT64_MAX;
+        max *= 10;
+    }
+    return max - 1;
+}
+
+// Values of the next frame from the current ones, for N axes of D digits
+// random() is rand() on the AVR: 8 bits of it are used per call. RANDOM holds a value for a second.
+template <size_t N, int D>
+class generator {
+   public:
+    static constexpr int64_t MAX = max_abs(D);
+
+    // Random value in -(MAX - 1)..MAX - 1
+    template <typename random_t>
+    static int64_t random_axis(random_t& random) {
+        // 8 calls give 64 bits of randomness
+        uint64_t r = 0;
+        for (uint8_t i = 0; i < 8; i++) {
+            r = (r << 8) | static_cast<uint8_t>(random());
+        }
+
+        // Scale to our desired range
+        int64_t v = static_cast<int64_t>(r % static_cast<uint64_t>(MAX));
+
+        if (random() & 0x01) v = -v;
+
+        return v;
+    }
+
+    // Leaves next untouched for TOOLPATH, which the caller plays
+    template <typename random_t>
+    void next(algorithm_t algorithm, const int64_t (&current)[N], int64_t (&next)[N], uint16_t frame_rate,
+              random_t&& random) {
+        switch (algorithm) {
+            case algorithm_t::RANDOM:
+                if (hold == 0) {
+                    for (size_t i = 0; i < N; ++i) next[i] = random_axis(random);
+                } else {
+                    for (size_t i = 0; i < N; ++i) next[i] = current[i];
+                }
+
+                if (++hold >= frame_rate) {
+                    hold = 0;
+                }
+
+                break;
+
+            case algorithm_t::INCREMENTING:
+                for (size_t i = 0; i < N; ++i) next[i] = (current[i] < MAX) ? current[i] + 1 : MAX;
+                break;
+
+            case algorithm_t::DECREMENTING:
+                for (size_t i = 0; i < N; ++i) next[i] = (current[i] > -MAX) ? current[i] - 1 : -MAX;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+   private:
+    // Frames the random values have been held
+    uint16_t hold = 0;
+};
+
+}  // namespace pattern
@@ -0,0 +1,147 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stdint.h>
+
+#include "bus.h"
+
+// Raw bus stream (transmitter diagnostic mode, see sampler.h)
+// The bus pins are sampled at a fixed period and every run of equal samples is sent as one record.
+// Records are three bytes and only their first byte has the top bit set, so a reader can start
+// anywhere in the stream:
+//   1 0 d5..d0   0 0 c5..c0   0 r6..r0     pins for r (1..127) sample periods,
+//                                          d: PD2..PD7 (W1..W8, ER, A7), c: PC0..PC5 (B0..B5)
+//   1 1 n19..n14 0 n13..n7    0 n6..n0     n samples were dropped because the link was busy
+// The stream starts with a "#r<hex>" line (see stamp.h) holding the sample period in nanoseconds.
+namespace raw {
+
+constexpr char TAG = 'r';
+
+constexpr uint8_t RECORD_SIZE = 3;
+constexpr uint8_t START = 0x80;
+constexpr uint8_t DROP = 0x40;
+constexpr uint8_t PAYLOAD = 0x7F;
+constexpr uint8_t MAX_RUN = 0x7F;
+constexpr uint32_t MAX_DROP = (1UL << 20) - 1;
+
+// Bus pins of one sample: PD2..PD7 in the low byte, PC0..PC5 in the high byte
+constexpr uint16_t snapshot(uint8_t pind, uint8_t pinc) {
+    return static_cast<uint16_t>((pind >> bus::W_SHIFT) | ((pinc & bus::B_MASK) << 8));
+}
+constexpr uint8_t pind_of(uint16_t pins) { return static_cast<uint8_t>((pins & 0x3F) << bus::W_SHIFT); }
+constexpr uint8_t pinc_of(uint16_t pins) { return static_cast<uint8_t>((pins >> 8) & bus::B_MASK); }
+
+// Run-length encoder, called once per sample
+// The sink is a byte queue with space() and push(). A run that does not fit is counted as
+// dropped, and the count goes out in a drop record ahead of the next run that fits.
+class encoder {
+   public:
+    template <typename Sink>
+    void sample(uint16_t pins, Sink& sink) {
+        if (pins == value && run < MAX_RUN) {
+            run++;
+            return;
+        }
+        if (run != 0) flush(sink);
+        value = pins;
+        run = 1;
+    }
+
+    // Samples lost since start
+    uint32_t dropped() const { return total; }
+
+    // True while runs are being dropped
+    bool dropping() const { return lost != 0; }
+
+   private:
+    template <typename Sink>
+    void flush(Sink& sink) {
+        if (sink.space() < (lost != 0 ? 2 * RECORD_SIZE : RECORD_SIZE)) {
+            lost = lost + run < MAX_DROP ? lost + run : MAX_DROP;
+            total += run;
+            return;
+        }
+        if (lost != 0) {
+            sink.push(static_cast<uint8_t>(START | DROP | (lost >> 14)));
+            sink.push(static_cast<uint8_t>((lost >> 7) & PAYLOAD));
+            sink.push(static_cast<uint8_t>(lost & PAYLOAD));
+            lost = 0;
+        }
+        sink.push(static_cast<uint8_t>(START | (value & 0x3F)));
+        sink.push(static_cast<uint8_t>(value >> 8));
+        sink.push(run);
+    }
+
+    uint16_t value = 0;
+    uint8_t run = 0;
+    uint32_t lost = 0;
+    uint32_t total = 0;
+};
+
+// Record parser for the host
+// Bytes that do not belong to a complete record (the header line, a partial record at the
+// start or after a lost byte) are skipped and counted.
+class decoder {
+   public:
+    enum result_t : uint8_t { NONE, RUN, DROPPED };
+
+    // Feed one byte, returns RUN or DROPPED when a record is complete
+    result_t feed(uint8_t byte) {
+        if (byte & START) {
+            if (count != 0) skipped_ += count;
+            count = 0;
+        } else if (count == 0) {
+            skipped_++;
+            return NONE;
+        }
+        bytes[count++] = byte;
+        if (count < RECORD_SIZE) return NONE;
+        count = 0;
+
+        if (bytes[0] & DROP) {
+            samples_ = (static_cast<uint32_t>(bytes[0] & 0x3F) << 14) | (static_cast<uint32_t>(bytes[1]) << 7) |
+                       bytes[2];
+            return DROPPED;
+        }
+        if (bytes[2] == 0) {
+            skipped_ += RECORD_SIZE;
+            return NONE;
+        }
+        pind_ = pind_of(bytes[0]);
+        pinc_ = bytes[1];
+        samples_ = bytes[2];
+        return RUN;
+    }
+
+    // Last record: pins and number of sample periods (RUN) or samples lost (DROPPED)
+    uint8_t pind() const { return pind_; }
+    uint8_t pinc() const { return pinc_; }
+    uint32_t samples() const { return samples_; }
+
+    // Bytes that were not part of a record
+    uint64_t skipped() const { return skipped_; }
+
+   private:
+    uint8_t bytes[RECORD_SIZE] = {};
+    uint8_t count = 0;
+    uint8_t pind_ = 0;
+    uint8_t pinc_ = bus::IDLE;
+    uint32_t samples_ = 0;
+    uint64_t skipped_ = 0;
+};
+
+}  // namespace raw
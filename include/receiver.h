@@ -16,20 +16,33 @@
 
 #pragma once
 
+#include <avr/eeprom.h>
 #include <util/delay.h>
 
+#include "autobaud.h"
 #include "config.h"
 #include "display.h"
+#include "flash.h"
 #include "format.h"
 #include "gpio.h"
+#include "histogram.h"
+#include "layout.h"
+#include "load.h"
+#include "parse.h"
+#include "ram.h"
+#include "stamp.h"
 #include "timer.h"
 #include "uart.h"
+#include "units.h"
+#include "uptime.h"
+#include "urgent.h"
 
 #define MODULE receiver
 
 namespace receiver {
 
-const char* const test_msg[] = {
+// Running dashes pattern for four displays, in flash
+const char test_msg[][4 * 11 + 1] PROGMEM = {
     "8.        :8.        :8.        :8.        \n",  //
     " 8.       : 8.       : 8.       : 8.       \n",  //
     "  8.      :  8.      :  8.      :  8.      \n",  //
@@ -41,31 +54,286 @@ const char* const test_msg[] = {
     "        8.:        8.:        8.:        8.\n"   //
 };
 
+// NCU status alerts for up to five displays, indexed by the status flags (see urgent.h), in flash
+const char alert_msg[][5 * 9 + 1] PROGMEM = {
+    "        :        :        :        :        \n",  //
+    "  Err   :  Err   :  Err   :  Err   :  Err   \n",  //
+    "   A7   :   A7   :   A7   :   A7   :   A7   \n",  //
+    " Err A7 : Err A7 : Err A7 : Err A7 : Err A7 \n"   //
+};
+
+// Link statistics in uptime ticks (0.5 us), buckets up to 2^23 ticks (4 s)
+using histogram_t = histogram::log2<24>;
+histogram_t inter_arrival;   // Newline to newline of consecutive data lines
+histogram_t render_latency;  // Newline of a data line to the end of the display update
+histogram_t data_age;        // Capture on the sender to the end of the display update
+histogram_t alert_latency;   // Status change on the sender to the end of the alert display update
+
+// Worst case of alert_latency: the line on the wire goes out first, then the status line, and the
+// receiver may still paint the data line received before it. Assumes the receiver keeps up with
+// the data lines (see the budget in display.h), and that the change is not held back by the gap
+// after the previous status line (see urgent::MAX_RATE).
+constexpr uint32_t LONGEST_LINE = uart::LINE_LENGTH > ram::LINE_SIZE - 1 ? uart::LINE_LENGTH : ram::LINE_SIZE - 1;
+constexpr uint32_t ALERT_LATENCY_US =
+    uart::wire_time(LONGEST_LINE + urgent::LINE_SIZE) / uptime::TICKS_PER_US + 2 * display::PAINT_TIME_US;
+
+// NCU status from the last status line; while it is active the alert blinks instead of the data
+constexpr uint32_t BLINK_PERIOD = uptime::TICKS_PER_SECOND / 4;
+uint8_t alert_status = 0;
+bool alert_visible = false;
+uint32_t alert_toggle = 0;
+
+// Sender clock, from the sync lines
+stamp::clock_sync sync;
+
+// Capture time of the next data line, from its time stamp line
+uint32_t capture_time = 0;
+bool capture_time_valid = false;
+
+// Newline of the previous data line
+uint32_t last_line_time = 0;
+bool last_line_time_valid = false;
+
+// Histograms are dumped as "#h<name> <bucket> <count>" lines every DUMP_PERIOD,
+// one line per main loop pass, skipping empty buckets, followed by the memory line (see ram.h)
+constexpr uint32_t DUMP_PERIOD = 10 * uptime::TICKS_PER_SECOND;
+constexpr uint8_t DUMP_IDLE = 0xFF;
+uint32_t last_dump = 0;
+uint8_t dump_histogram = DUMP_IDLE;
+uint8_t dump_bucket = 0;
+
+// Link watch: the rate is detected again after a RELOCK_PERIOD without a complete line, or with
+// RELOCK_ERRORS framing errors, as when the sender was started later or runs at another rate.
+// A live sender sends a status line every second at least (see urgent.h).
+constexpr uint32_t RELOCK_PERIOD = 2 * uptime::TICKS_PER_SECOND;
+constexpr uint16_t RELOCK_ERRORS = 16;
+uint32_t watch_start = 0;
+uint16_t watch_errors = 0;
+bool watch_lines = false;
+
+// Handle a '#' line
+inline void diagnostic(const char* msg) {
+    char tag;
+    uint32_t value;
+    if (!stamp::parse(msg, tag, value)) return;
+    if (tag == stamp::TIME) {
+        capture_time = value;
+        capture_time_valid = true;
+    } else if (uart::receiver::line_time_valid) {
+        sync.add(value, uart::receiver::line_time, uart::wire_time(stamp::LINE_SIZE, uart::receiver::rate));
+    }
+}
+
+// Send the next non-empty bucket of the dump in progress
+inline void dump() {
+    static const char names[] PROGMEM = {'i', 'r', 'a', 'e'};
+    const histogram_t* histograms[] = {&inter_arrival, &render_latency, &data_age, &alert_latency};
+
+    uint32_t now = uptime::now();
+    if (dump_histogram == DUMP_IDLE) {
+        if (now - last_dump < DUMP_PERIOD) return;
+        last_dump = now;
+        dump_histogram = 0;
+        dump_bucket = 0;
+    }
+
+    // Wait for room, a dump line must never delay anything else
+    char line[ram::LINE_SIZE];
+    if (uart::transmitter::tx_buffer.space() < sizeof(line)) return;
+
+    while (dump_histogram < sizeof(names)) {
+        const histogram_t& h = *histograms[dump_histogram];
+        while (dump_bucket < sizeof(h.count) / sizeof(h.count[0])) {
+            uint8_t bucket = dump_bucket++;
+            if (h.count[bucket] == 0) continue;
+            sprintf_P(line, PSTR("#h%c %u %u\n"), flash::read(&names[dump_histogram]), bucket, h.count[bucket]);
+            uart::transmitter::transmit(line);
+            return;
+        }
+        dump_histogram++;
+        dump_bucket = 0;
+    }
+    ram::write(line);
+    uart::transmitter::transmit(line);
+    dump_histogram = DUMP_IDLE;
+}
+
+// Line with converted values
+char converted[uart::BUFFER_SIZE];
+
+// Apply the unit jumpers to a data line
+// Returns the line to display; lines that do not parse are shown as they are
+template <size_t AXIS_COUNT_T = AXIS_COUNT, int AXIS_DIGIT_COUNT_T = AXIS_DIGIT_COUNT,
+          int AXIS_DOT_POSITION_T = AXIS_DOT_POSITION>
+const char* convert(const char* msg) {
+    uint8_t mode = gpio::inch_jumper() ? units::INCH : units::MM;
+    bool diameter = gpio::diameter_jumper();
+    if (mode == units::MM && !diameter) return msg;
+
+    int32_t axis[AXIS_COUNT_T];
+    if (!parse<AXIS_COUNT_T, AXIS_DIGIT_COUNT_T, AXIS_DOT_POSITION_T>(msg, axis)) return msg;
+
+    uint8_t modes[AXIS_COUNT_T];
+    for (uint8_t i = 0; i < AXIS_COUNT_T; i++) {
+        modes[i] = (diameter && (DIAMETER_AXES & (1 << i))) ? mode | units::DIAMETER : mode;
+    }
+    units::convert<AXIS_DIGIT_COUNT_T, AXIS_DOT_POSITION_T>(axis, modes);
+
+    // Converted values are clamped to the layout, so the 32-bit format fits
+    if (mode == units::INCH) {
+        constexpr int inch_dot = units::inch<AXIS_DOT_POSITION_T>::DOT_POSITION;
+        return format<AXIS_COUNT_T, AXIS_DIGIT_COUNT_T, inch_dot>(axis, converted);
+    }
+    return format<AXIS_COUNT_T, AXIS_DIGIT_COUNT_T, AXIS_DOT_POSITION_T>(axis, converted);
+}
+
 // Draw running dashes to indicate waiting for data
-inline void check_display_mode() {
+template <uint8_t CHIPS = AXIS_COUNT>
+void check_display_mode() {
     for (uint8_t column = 0; column < 8; column++) {
-        display::write(test_msg[column]);
-        while (display::update());
+        display::write<CHIPS>(flash::string(test_msg[column]));
+        while (display::update<CHIPS>());
         _delay_ms(100);
     }
 }
 
+// Render path of one layout: everything that depends on the layout, compiled for it
+template <size_t AXIS_COUNT_T, int AXIS_DIGIT_COUNT_T, int AXIS_DOT_POSITION_T>
+struct renderer {
+    static constexpr uint8_t CHIPS = AXIS_COUNT_T;
+
+    static void init() { display::init<CHIPS>(); }
+
+    static void test() {
+        check_display_mode<CHIPS>();
+        display::clear<CHIPS>();
+    }
+
+    static void show(const char* msg) {
+        display::write<CHIPS>(convert<AXIS_COUNT_T, AXIS_DIGIT_COUNT_T, AXIS_DOT_POSITION_T>(msg));
+        while (display::update<CHIPS>());
+    }
+
+    static void alert(uint8_t status) {
+        display::write<CHIPS>(flash::string(alert_msg[status]));
+        while (display::update<CHIPS>());
+    }
+};
+
+struct layout_t {
+    void (*init)();
+    void (*test)();
+    void (*show)(const char* msg);
+    void (*alert)(uint8_t status);
+};
+
+// Table entry of layout I, slots past layout::COUNT repeat the build layout
+template <uint8_t I>
+constexpr layout_t entry() {
+    constexpr uint16_t c = layout::at(I < layout::COUNT ? I : 0);
+    using r = renderer<layout::axes(c), layout::digits(c), layout::dot(c)>;
+    return {&r::init, &r::test, &r::show, &r::alert};
+}
+
+// Function table of the layouts in the image, in flash
+const layout_t LAYOUTS[layout::MAX_COUNT] PROGMEM = {entry<0>(), entry<1>(), entry<2>(), entry<3>(),
+                                                     entry<4>(), entry<5>(), entry<6>()};
+
+// Layout selected at boot
+layout_t active;
+
 void init() {
     gpio::init();
-    display::init();
-    uart::receiver::init();
-    check_display_mode();
-    display::clear();
+    const uint8_t index = layout::select(gpio::layout_jumpers(),
+                                         eeprom_read_byte(reinterpret_cast<const uint8_t*>(layout::EEPROM_ADDRESS)));
+    active = flash::read(&LAYOUTS[index]);
+    active.init();
+
+    // Follow the sender rate, so the link speed can be changed without reflashing the receiver
+    const baud::setting setting = autobaud::detect(uart::BAUD);
+    uart::receiver::init(setting);
+    uart::transmitter::init(setting);
+    uptime::init();
+    active.test();
+}
+
+// Detect the rate again when the link looks lost, see RELOCK_PERIOD
+inline void watch_link(bool line) {
+    watch_lines = watch_lines || line;
+    if (uptime::now() - watch_start < RELOCK_PERIOD) return;
+    const uint16_t errors = static_cast<uint16_t>(uart::receiver::framing_errors.load() - watch_errors);
+    if (!watch_lines || errors >= RELOCK_ERRORS) {
+        const baud::setting setting = autobaud::detect(baud::solve(F_CPU, uart::receiver::rate));
+        irq::critical_section lock;
+        uart::receiver::init(setting);
+        uart::transmitter::init(setting);
+    }
+    watch_start = uptime::now();
+    watch_errors = uart::receiver::framing_errors.load();
+    watch_lines = false;
+}
+
+// Handle a '!' line: a new active status is painted at once, ahead of any data line
+inline void status(const char* msg) {
+    uint8_t value;
+    uint32_t time;
+    if (!urgent::parse(msg, value, time) || value == alert_status) return;
+    alert_status = value;
+    if (value == 0) return;  // The next data line repaints the display
+
+    active.alert(value);
+    alert_visible = true;
+    alert_toggle = uptime::now();
+    if (sync.valid()) alert_latency.add(alert_toggle - sync.to_local(time));
+}
+
+// Blink the alert while the status is active
+inline void blink() {
+    if (alert_status == 0) return;
+    uint32_t now = uptime::now();
+    if (now - alert_toggle < BLINK_PERIOD) return;
+    alert_toggle = now;
+    alert_visible = !alert_visible;
+    active.alert(alert_visible ? alert_status : 0);
+}
+
+// Send the next line of a load report when there is room, one per pass (see load.h)
+inline void report_load() {
+    if (!load::due()) return;
+    char line[load::LINE_SIZE];
+    if (uart::transmitter::tx_buffer.space() < sizeof(line) || !load::write(line)) return;
+    uart::transmitter::transmit(line);
 }
 
 void update() {
     // Check if a complete message has been received
     auto msg = uart::receiver::get_message();
-    if (msg != nullptr) {
-        // Start display update
-        display::write(msg);
-        while (display::update());
+    if (msg != nullptr && msg[0] == urgent::PREFIX) {
+        status(msg);
+    } else if (msg != nullptr && msg[0] == stamp::PREFIX) {
+        diagnostic(msg);
+    } else if (msg != nullptr) {
+        uint32_t line_time = uart::receiver::line_time;
+        bool line_time_valid = uart::receiver::line_time_valid;
+
+        // Display update through the layout's own path, unless an alert holds the display
+        if (alert_status == 0) {
+            active.show(msg);
+            uint32_t done = uptime::now();
+            if (line_time_valid) render_latency.add(done - line_time);
+            if (capture_time_valid && sync.valid()) data_age.add(done - sync.to_local(capture_time));
+        }
+
+        if (line_time_valid && last_line_time_valid) inter_arrival.add(line_time - last_line_time);
+        last_line_time = line_time;
+        last_line_time_valid = line_time_valid;
+        capture_time_valid = false;
     }
+
+    watch_link(msg != nullptr);
+    blink();
+    dump();
+    report_load();
 }
 
 }  // namespace receiver
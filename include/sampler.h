@@ -0,0 +1,138 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+#include "baud.h"
+#include "config.h"
+#include "gpio.h"
+#include "irq.h"
+#include "load.h"
+#include "raw.h"
+#include "stamp.h"
+#include "uart.h"
+#include "uptime.h"
+
+// Raw bus stream (transmitter only)
+// Sending COMMAND to the transmitter turns it into a logic analyzer: Timer2 samples PIND and PINC
+// every RAW_SAMPLE_PERIOD_US and the runs of equal samples go out at the fastest rate the USART can
+// generate (see raw.h for the format). The same interrupt feeds the USART, and start() turns off the
+// uptime overflow interrupt, the last other one left, so samples are taken at a fixed offset from the
+// compare match. When the link cannot keep up, runs are dropped and counted in the stream, and debug
+// pin 0 is high while that happens. Only a reset ends the stream.
+namespace sampler {
+
+// Serial command that starts the stream
+constexpr char COMMAND = 'R';
+
+// Fastest rate of baud::RATES at F_CPU
+constexpr baud::setting BAUD = baud::solve(F_CPU, baud::fastest(F_CPU));
+static_assert(BAUD.valid, "No standard baud rate can be generated from F_CPU");
+
+// Timer2 runs at F_CPU / 8
+constexpr uint32_t TIMER_HZ = F_CPU / 8;
+constexpr uint32_t COUNTS = static_cast<uint32_t>(RAW_SAMPLE_PERIOD_US) * (TIMER_HZ / 1000) / 1000;
+static_assert(COUNTS >= 1 && COUNTS <= 256, "RAW_SAMPLE_PERIOD_US is out of the Timer2 range at this F_CPU");
+
+// Longest run of the interrupt handler, in CPU cycles, so a sample is never taken late
+// Counted on the worst path, a run record behind a drop record in a LOAD_METER build:
+//   response, vector, prologue and epilogue saving SREG, r0, r1 and 12 clobbered registers  ~75
+//   load probe: two 16-bit TCNT1 reads and a 32-bit add                                    ~20
+//   pin reads, UDRE test, ring pop and UDR0 write                                          ~20
+//   encoder: run compare, space() and the 32-bit lost test                                 ~20
+//   six ring pushes (~12 each), the lost shifts and clearing lost                          ~95
+//   debug pin                                                                               ~5
+// The sum is about 235 cycles; the bound leaves some margin for the code generator.
+constexpr uint32_t MIN_CYCLES = 256;
+static_assert(COUNTS * 8 >= MIN_CYCLES, "RAW_SAMPLE_PERIOD_US is too short for this F_CPU");
+
+// Sample period actually set, in nanoseconds
+constexpr uint32_t PERIOD_NS = static_cast<uint32_t>(COUNTS * 1000000000ULL / TIMER_HZ);
+
+// Link budget: one byte goes out per sample at most, a record takes RECORD_SIZE bytes
+constexpr uint32_t BYTES_PER_SECOND = BAUD.rate / uart::BITS_PER_BYTE;
+constexpr uint32_t SAMPLES_PER_SECOND = 1000000000UL / PERIOD_NS;
+constexpr uint32_t RECORDS_PER_SECOND =
+    (BYTES_PER_SECOND < SAMPLES_PER_SECOND ? BYTES_PER_SECOND : SAMPLES_PER_SECOND) / raw::RECORD_SIZE;
+
+// Pause between the command and the stream, so the host can switch to the new rate
+constexpr uint32_t START_DELAY = uptime::TICKS_PER_SECOND / 2;
+
+// Records waiting for the USART, both ends owned by the Timer2 interrupt
+irq::ring_buffer<uint8_t, 128> buffer;
+
+// Run-length encoder, owned by the Timer2 interrupt
+raw::encoder encoder;
+
+bool running = false;
+
+// Listen for COMMAND on RX, with a pull-up so an open input does not produce bytes
+inline void init() {
+    PORTD |= static_cast<uint8_t>(_BV(PD0));
+    UCSR0B |= static_cast<uint8_t>(_BV(RXEN0));
+}
+
+// True when COMMAND was received, called from the main loop
+inline bool requested() {
+    if (!(UCSR0A & _BV(RXC0))) return false;
+    return UDR0 == static_cast<uint8_t>(COMMAND);
+}
+
+// Switch the link over to the raw stream, called from the main loop once the other interrupts
+// using the pins are off
+inline void start() {
+    // Let the lines already queued go out at the normal rate
+    while (!uart::transmitter::tx_buffer.empty() || !uart::transmitter::urgent_buffer.empty()) {
+    }
+    uint32_t begin = uptime::now();
+    while (uptime::now() - begin < START_DELAY) {
+    }
+    // Nothing reads the uptime from here on; Timer1 keeps counting for the load probes
+    TIMSK1 &= static_cast<uint8_t>(~_BV(TOIE1));
+    UCSR0B &= static_cast<uint8_t>(~(_BV(UDRIE0) | _BV(RXEN0)));
+    uart::set_baud(BAUD);
+
+    char header[stamp::LINE_SIZE];
+    stamp::write(header, raw::TAG, PERIOD_NS);
+    for (char c : header) buffer.push(static_cast<uint8_t>(c));
+
+    TCCR2A = 0;
+    TCCR2B = 0;
+    TCNT2 = 0;
+    OCR2A = static_cast<uint8_t>(COUNTS - 1);
+    TCCR2A = _BV(WGM21);   // Set CTC mode
+    TCCR2B = _BV(CS21);    // Set prescaler to 8
+    TIMSK2 = _BV(OCIE2A);  // Enable Timer2 compare interrupt
+    running = true;
+}
+
+// Timer2 interrupt handler
+ISR(TIMER2_COMPA_vect) {
+    load::probe<load::TIMER2> probe;
+    // Pins first, so the sample time does not depend on the path taken below
+    uint8_t pind = PIND;
+    uint8_t pinc = PINC;
+
+    uint8_t byte;
+    if ((UCSR0A & _BV(UDRE0)) && buffer.pop(byte)) UDR0 = byte;
+
+    encoder.sample(raw::snapshot(pind, pinc), buffer);
+    gpio::debug<0>(encoder.dropping() ? 1 : 0);
+}
+
+}  // namespace sampler
@@ -0,0 +1,51 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stdint.h>
+
+#include "flash.h"
+
+// MAX7219 segment patterns (no decode mode): bit 7 is the dot, bits 6..0 are segments A..G
+namespace segments {
+
+constexpr uint8_t DOT = 0x80;
+
+// Printable ASCII from FIRST, in flash; characters that cannot be shown are blank
+constexpr char FIRST = 0x20;
+constexpr uint8_t COUNT = 0x60;
+const uint8_t GLYPHS[COUNT] PROGMEM = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 0x20   ! " # $ % & '
+    0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x80, 0x00,  // 0x28 ( ) * + , - . /
+    0x7E, 0x30, 0x6D, 0x79, 0x33, 0x5B, 0x5F, 0x70,  // 0x30 0 1 2 3 4 5 6 7
+    0x7F, 0x7B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 0x38 8 9 : ; < = > ?
+    0x00, 0x77, 0x1F, 0x4E, 0x3D, 0x4F, 0x47, 0x00,  // 0x40 @ A B C D E F G
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1D,  // 0x48 H I J K L M N O
+    0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00,  // 0x50 P Q R S T U V W
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 0x58 X Y Z [ \ ] ^ _
+    0x00, 0x77, 0x1F, 0x4E, 0x3D, 0x4F, 0x47, 0x00,  // 0x60 ` a b c d e f g
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1D,  // 0x68 h i j k l m n o
+    0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00,  // 0x70 p q r s t u v w
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 0x78 x y z { | } ~
+};
+
+}  // namespace segments
+
+// Convert ASCII character to segment representation
+inline uint8_t segment_from_ascii(char c) {
+    const uint8_t index = static_cast<uint8_t>(c - segments::FIRST);
+    return index < segments::COUNT ? flash::read(&segments::GLYPHS[index]) : 0x00;
+}
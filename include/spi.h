@@ -20,12 +20,31 @@
 #include <avr/io.h>
 #include <util/delay.h>
 
+#include "irq.h"
+#include "load.h"
+#include "loopback.h"
+
 namespace spi {
 
+// SPI clock after init(), F_CPU / 128
+// The display calibrates a faster one at boot (see loopback.h); timing budgets assume this one, the slowest.
+constexpr uint32_t PRESCALER = 128;
+constexpr uint32_t CLOCK_HZ = F_CPU / PRESCALER;
+
+// Cycles from the end of one byte to the start of the next: interrupt entry, ISR body and exit
+constexpr uint32_t ISR_CYCLES = 60;
+
+// Time to transfer a buffer of a number of bytes, in nanoseconds
+constexpr uint32_t transfer_time_ns(uint32_t bytes) {
+    return bytes * (8 * (1000000000 / CLOCK_HZ) + ISR_CYCLES * (1000000000 / F_CPU));
+}
+
+// Buffer pointers are set up by transmit() before the interrupt is enabled
+// and then owned by the ISR until transmitting is cleared
 volatile uint8_t* buffer = nullptr;
 volatile uint8_t buffer_pos = 0;
 volatile uint8_t buffer_size = 0;
-volatile bool transmitting = false;
+irq::atomic<bool> transmitting = false;
 
 // Initialize SPI
 // Set spi mode 0, MSB first, 125 kHz clock (assuming 16MHz system clock), master mode
@@ -46,6 +65,17 @@ inline void init() {
     SPCR = static_cast<uint8_t>((_BV(SPE) | _BV(MSTR) | _BV(SPR1) | _BV(SPR0)));
 }
 
+// Set the clock to F_CPU / loopback::divider(rate)
+inline void set_rate(const uint8_t rate) {
+    const loopback::setting s = loopback::control(rate);
+    SPCR = static_cast<uint8_t>((SPCR & ~(_BV(SPR1) | _BV(SPR0))) | (s.spr << SPR0));
+    if (s.spi2x) {
+        SPSR |= static_cast<uint8_t>(_BV(SPI2X));
+    } else {
+        SPSR &= static_cast<uint8_t>(~_BV(SPI2X));
+    }
+}
+
 // Enable chip select
 inline void start() { PORTB &= static_cast<uint8_t>(~_BV(PB2)); }
 
@@ -54,13 +84,7 @@ inline void stop() { PORTB |= static_cast<uint8_t>(_BV(PB2)); }
 
 // Check if SPI is busy transmitting data
 // Returns true if transmission is ongoing
-inline bool is_busy() {
-    uint8_t sreg = SREG;
-    cli();
-    bool busy = transmitting;
-    SREG = sreg;
-    return busy;
-}
+inline bool is_busy() { return transmitting.load(); }
 
 // Wait until SPI transmission is complete
 inline void wait_until_done() {
@@ -78,7 +102,7 @@ void transmit(volatile uint8_t* data) {
     buffer = data;
     buffer_size = size;
     buffer_pos = 0;
-    transmitting = true;
+    transmitting.store(true);
 
     // Enable chip select
     start();
@@ -90,6 +114,21 @@ void transmit(volatile uint8_t* data) {
     SPCR |= static_cast<uint8_t>(_BV(SPIE));
 }
 
+// Exchange a buffer at a rate with chip select held low, polling without the interrupt
+// The clock stays at that rate. Used by the display calibration only, before any transmit().
+inline void shift(const uint8_t rate, const uint8_t* tx, uint8_t* rx, const uint8_t size) {
+    wait_until_done();
+    set_rate(rate);
+    start();
+    for (uint8_t i = 0; i < size; i++) {
+        SPDR = tx[i];
+        while (!(SPSR & _BV(SPIF))) {
+        }
+        rx[i] = SPDR;
+    }
+    stop();
+}
+
 /**
  * @brief SPI Serial Transfer Complete Interrupt Service Routine.
  *
@@ -103,12 +142,13 @@ void transmit(volatile uint8_t* data) {
  * position.
  */
 ISR(SPI_STC_vect) {
+    load::probe<load::SPI> probe;
     gpio::debug<0>(1);
 
     if (buffer_pos >= buffer_size) {
         stop();
         SPCR &= static_cast<uint8_t>(~_BV(SPIE));
-        transmitting = false;
+        transmitting.store(false);
     } else {
         SPDR = buffer[buffer_pos++];
     }
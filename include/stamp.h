@@ -0,0 +1,110 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+#include "flash.h"
+
+// Diagnostic lines on the serial link
+// Lines starting with '#' are not data lines and are never shown on the display:
+//   #t<hex>  capture time of the data line that follows, in sender uptime ticks
+//   #s<hex>  sender uptime when the line was queued, for clock synchronization
+//   #h...    receiver statistics (see receiver.h)
+//   #m...    memory use (see ram.h)
+//   #r<hex>  sample period in nanoseconds, starts the transmitter raw bus stream (see raw.h)
+// Lines starting with '!' are urgent lines, sent ahead of everything else (see urgent.h).
+namespace stamp {
+
+constexpr char PREFIX = '#';
+constexpr char TIME = 't';
+constexpr char SYNC = 's';
+
+// "#t" + 8 hex digits + newline
+constexpr size_t LINE_SIZE = 11;
+
+// Write a time or sync line, returns the position after the newline (not zero-terminated)
+// Cheap enough for an interrupt handler
+inline char* write(char* out, char tag, uint32_t value) {
+    static const char digits[] PROGMEM = "0123456789abcdef";
+    *out++ = PREFIX;
+    *out++ = tag;
+    for (int8_t shift = 28; shift >= 0; shift -= 4) *out++ = flash::read(&digits[(value >> shift) & 0x0F]);
+    *out++ = '\n';
+    return out;
+}
+
+// Parse exactly 8 lower case hex digits up to the end of the line
+inline bool parse_hex(const char* p, uint32_t& value) {
+    value = 0;
+    uint8_t count = 0;
+    for (; *p; p++, count++) {
+        char c = *p;
+        uint8_t nibble;
+        if (c >= '0' && c <= '9') {
+            nibble = static_cast<uint8_t>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = static_cast<uint8_t>(c - 'a' + 10);
+        } else {
+            return false;
+        }
+        value = (value << 4) | nibble;
+    }
+    return count == 8;
+}
+
+// Parse a line without the newline
+// Returns false if it is not a time or sync line
+inline bool parse(const char* line, char& tag, uint32_t& value) {
+    if (line[0] != PREFIX || (line[1] != TIME && line[1] != SYNC)) return false;
+    tag = line[1];
+    return parse_hex(line + 2, value);
+}
+
+// Offset between the sender and the receiver clock
+// Every sync line gives receiver_time - sender_time, plus the time the line spent in queues and
+// on the wire. The smallest sample of a window is the best estimate; a new window is started
+// every WINDOW samples so drift between the two crystals is followed.
+class clock_sync {
+   public:
+    static constexpr uint8_t WINDOW = 8;
+
+    // sent: sender time from the sync line, received: receiver time of its newline,
+    // wire: transmission time of the line itself
+    void add(uint32_t sent, uint32_t received, uint32_t wire) {
+        int32_t sample = static_cast<int32_t>(received - sent - wire);
+        if (count == 0 || sample - best < 0) best = sample;
+        if (++count >= WINDOW) {
+            offset_ = best;
+            valid_ = true;
+            count = 0;
+        }
+    }
+
+    // Receiver time of a sender time
+    uint32_t to_local(uint32_t sender_time) const { return sender_time + static_cast<uint32_t>(offset_); }
+
+    bool valid() const { return valid_; }
+    int32_t offset() const { return offset_; }
+
+   private:
+    int32_t best = 0;
+    int32_t offset_ = 0;
+    uint8_t count = 0;
+    bool valid_ = false;
+};
+
+}  // namespace stamp
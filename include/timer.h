@@ -19,6 +19,7 @@
 #include <avr/io.h>
 
 #include "config.h"
+#include "load.h"
 
 namespace timer {
 
@@ -40,6 +41,7 @@ inline void init(callback_t _callback) {
 
 // Timer0 interrupt handler
 ISR(TIMER0_COMPA_vect) {
+    load::probe<load::TIMER0> probe;
     if (callback != nullptr) callback();
 }
 
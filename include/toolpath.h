@@ -0,0 +1,129 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "flash.h"
+
+// Compiled toolpath: axis values sampled at FRAME_RATE, in units of the last displayed digit
+// Made from a G-code program by razmer2m_gcode (see tools/gcode.h) and played back by the emulator.
+//
+// Every frame each axis moves by a fixed point step with STEP_FRACTION_BITS fractional bits, so a
+// straight move is one record however long it is, and an arc is a few chords. The shown value is
+// the integer part. The encoder chooses the steps so that every frame shows the sampled value, exactly
+// or within a tolerance given at build time.
+//
+// Stream, all numbers are LEB128 varints, signed ones zigzag encoded:
+//   header: start value of every axis (signed)
+//   record: mask byte (bit i: axis i gets a new step, END: end of the program),
+//           frame count (1..MAX_FRAMES), new step of every axis in the mask (signed)
+// Steps not in the mask are kept from the previous record; the program starts with all steps 0.
+namespace toolpath {
+
+constexpr uint8_t STEP_FRACTION_BITS = 8;
+constexpr uint8_t END = 0x80;
+constexpr uint16_t MAX_FRAMES = 0xFFFF;
+
+// Fraction the playback starts with: half a unit, so the first steps can go either way
+constexpr uint8_t START_FRACTION = 0x80;
+
+constexpr uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+constexpr int32_t unzigzag(uint32_t value) {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+// Playback from flash, one call of step() per frame
+// A frame costs an add with carry per axis; a record is read only when the previous one runs out.
+template <size_t N = AXIS_COUNT>
+class player {
+   public:
+    explicit player(const uint8_t* data) : begin(data), next(data) { restart(); }
+
+    // Back to the start of the program
+    void restart() {
+        next = flash::ptr<uint8_t>(begin);
+        for (size_t i = 0; i < N; i++) {
+            value[i] = unzigzag(read_varint());
+            fraction[i] = START_FRACTION;
+            whole[i] = 0;
+            part[i] = 0;
+        }
+        remaining = 0;
+        ended = false;
+    }
+
+    // Advance one frame; at the end of the program the values hold until restart()
+    void step() {
+        if (remaining == 0 && !read_record()) return;
+        remaining--;
+        for (size_t i = 0; i < N; i++) {
+            uint16_t sum = static_cast<uint16_t>(fraction[i] + part[i]);
+            fraction[i] = static_cast<uint8_t>(sum);
+            value[i] += whole[i] + (sum >> STEP_FRACTION_BITS);
+        }
+    }
+
+    bool finished() const { return ended; }
+
+    // Current value of an axis
+    int32_t operator[](size_t i) const { return value[i]; }
+
+   private:
+    uint32_t read_varint() {
+        uint32_t result = 0;
+        uint8_t shift = 0;
+        uint8_t byte;
+        do {
+            byte = *next++;
+            result |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            shift = static_cast<uint8_t>(shift + 7);
+        } while (byte & 0x80);
+        return result;
+    }
+
+    bool read_record() {
+        if (ended) return false;
+        uint8_t mask = *next++;
+        if (mask & END) {
+            ended = true;
+            return false;
+        }
+        remaining = static_cast<uint16_t>(read_varint());
+        for (size_t i = 0; i < N; i++) {
+            if (!(mask & (1 << i))) continue;
+            int32_t s = unzigzag(read_varint());
+            whole[i] = s >> STEP_FRACTION_BITS;  // Arithmetic shift: floor
+            part[i] = static_cast<uint8_t>(s);
+        }
+        return true;
+    }
+
+    const uint8_t* begin;
+    flash::ptr<uint8_t> next;
+    int32_t value[N];
+    uint8_t fraction[N];
+    int32_t whole[N];
+    uint8_t part[N];
+    uint16_t remaining = 0;
+    bool ended = false;
+};
+
+}  // namespace toolpath
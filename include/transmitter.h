@@ -16,24 +16,168 @@
 
 #pragma once
 
+#include "bus.h"
 #include "config.h"
 #include "display.h"
 #include "format.h"
 #include "gpio.h"
+#include "irq.h"
+#include "load.h"
+#include "ram.h"
+#include "sampler.h"
+#include "stamp.h"
 #include "timer.h"
 #include "uart.h"
+#include "uptime.h"
+#include "urgent.h"
 
 #define MODULE transmitter
 
 namespace transmitter {
 
+// Razmer 2M bus decoder, owned by the pin change interrupt
+bus::decoder<> decoder;
+
+// Bus frame with the uptime at which it was complete
+struct stamped_frame {
+    bus::frame<> frame;
+    uint32_t time;
+};
+
+// Last complete bus frame
+irq::seqlock<stamped_frame> frame;
+
+// Version of the last frame sent
+uint8_t sent_version = 0;
+
+// Time stamp line followed by the data line
+char msg[uart::MESSAGE_SIZE];
+
+// Clock sync lines go out about once a second
+constexpr uint32_t SYNC_PERIOD = uptime::TICKS_PER_SECOND;
+uint32_t last_sync = 0;
+
+// Memory lines go out every MEMORY_PERIOD, after a data line and only where they fit
+constexpr uint32_t MEMORY_PERIOD = ram::PERIOD_SECONDS * uptime::TICKS_PER_SECOND;
+uint32_t last_memory = 0;
+char memory_msg[ram::LINE_SIZE];
+bool memory_ready = false;
+
+// NCU status last queued and when, the status is repeated every STATUS_PERIOD and lines are at
+// least STATUS_GAP apart (see urgent::MAX_RATE)
+constexpr uint32_t STATUS_PERIOD = uptime::TICKS_PER_SECOND;
+constexpr uint32_t STATUS_GAP = uptime::TICKS_PER_SECOND / urgent::MAX_RATE;
+uint8_t reported_status = 0;
+uint32_t last_status = 0 - STATUS_GAP;
+char status_msg[urgent::LINE_SIZE + 1];
+
+// Pin change interrupt of B0..B5: every strobe edge
+ISR(PCINT1_vect) {
+    load::probe<load::PCINT1> probe;
+    uint8_t pinc = PINC;
+    uint8_t pind = PIND;
+    if (decoder.sample(pind, pinc)) frame.store({decoder.last(), uptime::now()});
+}
+
+// Queue the status line, called with interrupts masked
+// When the urgent queue is full the change is picked up again by the main loop
+void report_status(uint8_t status, uint32_t now) {
+    *urgent::write(status_msg, status, now) = '\0';
+    if (!uart::transmitter::transmit_urgent(status_msg)) return;
+    reported_status = status;
+    last_status = now;
+}
+
+// Pin change interrupt of ER and A7: status changes go out at once, even when the bus is not scanned,
+// unless the last status line is less than STATUS_GAP old; the main loop sends them when the gap ends
+ISR(PCINT2_vect) {
+    load::probe<load::PCINT2> probe;
+    uint8_t status = urgent::status_of(PIND);
+    uint32_t now = uptime::now();
+    if (status != reported_status && now - last_status >= STATUS_GAP) report_status(status, now);
+}
+
 void init() {
     gpio::init();
     uart::transmitter::init();
+    uptime::init();
+    sampler::init();
+
+    // Enable pin change interrupt on B0..B5, and on ER and A7 (PCINT22, PCINT23)
+    PCMSK1 = bus::B_MASK;
+    PCMSK2 = bus::STATUS_MASK;
+    PCICR |= static_cast<uint8_t>(_BV(PCIE1) | _BV(PCIE2));
+}
+
+// Leave the decoder and stream the raw bus pins until reset
+void start_sampler() {
+    PCICR &= static_cast<uint8_t>(~(_BV(PCIE1) | _BV(PCIE2)));
+    sampler::start();
+}
+
+// Catch up with a status change the interrupt could not queue, and repeat the status, cleared
+// or not, so a receiver that lost a status line follows again within STATUS_PERIOD
+void check_status() {
+    irq::critical_section lock;
+    uint32_t now = uptime::now();
+    if (now - last_status < STATUS_GAP) return;
+    uint8_t status = urgent::status_of(PIND);
+    if (status != reported_status || now - last_status >= STATUS_PERIOD) report_status(status, now);
+}
+
+// Send the memory line when it is due, once it fits behind the data line
+void report_memory() {
+    uint32_t now = uptime::now();
+    if (!memory_ready && now - last_memory >= MEMORY_PERIOD) {
+        last_memory = now;
+        ram::write(memory_msg);
+        memory_ready = true;
+    }
+    if (memory_ready && uart::transmitter::transmit_spare(memory_msg)) memory_ready = false;
+}
+
+// Send the next line of a load report when there is room, one per pass (see load.h)
+void report_load() {
+    if (!load::due()) return;
+    char line[load::LINE_SIZE];
+    if (uart::transmitter::tx_buffer.space() < sizeof(line) || !load::write(line)) return;
+    uart::transmitter::transmit(line);
+}
+
+// Send every new frame
+void send_frame() {
+    uint8_t version = frame.version();
+    if (version == sent_version) return;
+    sent_version = version;
+
+    stamped_frame current = frame.load();
+    int64_t axis[AXIS_COUNT];
+    if (!bus::decode(current.frame, axis)) return;
+
+    // Sync line first, while the queue is most likely empty
+    uint32_t now = uptime::now();
+    if (now - last_sync >= SYNC_PERIOD) {
+        last_sync = now;
+        *stamp::write(msg, stamp::SYNC, now) = '\0';
+        uart::transmitter::transmit(msg);
+    }
+
+    format(axis, stamp::write(msg, stamp::TIME, current.time));
+    uart::transmitter::transmit(msg);
 }
 
 void update() {
-    // Transmitter update logic
+    if (sampler::running) return;
+    if (sampler::requested()) {
+        start_sampler();
+        return;
+    }
+
+    // Diagnostic lines behind the data line, so they never take its room
+    check_status();
+    send_frame();
+    report_memory();
+    report_load();
 }
 
 }  // namespace transmitter
@@ -18,32 +18,99 @@
 #include <avr/interrupt.h>
 #include <avr/io.h>
 
+#include "baud.h"
 #include "config.h"
+#include "irq.h"
+#include "load.h"
+#include "ram.h"
+#include "stamp.h"
+#include "uptime.h"
+#include "urgent.h"
 
 namespace uart {
 
 // Max digits per axis + separators + null terminator
 constexpr size_t BUFFER_SIZE = AXIS_COUNT * 10 + 1;
 
-// Define UART divider
-constexpr uint32_t DIVIDER = static_cast<uint32_t>(F_CPU / 16 / BAUDRATE - 1);
+// Data line preceded by its time stamp line
+constexpr size_t MESSAGE_SIZE = BUFFER_SIZE + stamp::LINE_SIZE;
+
+// Ring buffer capacity: the smallest power of two that holds a number of bytes
+constexpr uint8_t ring_capacity(size_t size) {
+    uint8_t capacity = 1;
+    while (capacity < size) capacity = static_cast<uint8_t>(capacity << 1);
+    return capacity;
+}
+
+// Bytes queued for transmission in one frame at most: the sync line, a stamped data line, then the memory line
+constexpr size_t TX_FRAME_SIZE = stamp::LINE_SIZE + MESSAGE_SIZE - 1 + ram::LINE_SIZE - 1;
+
+// Transmit ring: a whole frame, so the data line is not dropped when the sync line goes first
+constexpr uint8_t TX_RING_SIZE = ring_capacity(TX_FRAME_SIZE);
+
+// Receive ring: a whole message
+constexpr uint8_t RX_RING_SIZE = ring_capacity(MESSAGE_SIZE);
+
+// Time on the wire of a number of bytes in uptime ticks (start + 8 data + stop bits)
+constexpr uint32_t wire_time(size_t bytes, uint32_t rate = BAUDRATE) {
+    return static_cast<uint32_t>(bytes * 10 * uptime::TICKS_PER_SECOND / rate);
+}
+
+// Divider and mode for BAUDRATE
+constexpr baud::setting BAUD = baud::solve(F_CPU, BAUDRATE);
+static_assert(BAUD.valid, "BAUDRATE cannot be generated from F_CPU within 2%, pick another rate");
+
+// Program the baud rate generator
+inline void set_baud(const baud::setting& setting) {
+    UBRR0 = setting.ubrr;
+    UCSR0A = setting.u2x ? static_cast<uint8_t>(_BV(U2X0)) : static_cast<uint8_t>(0);
+}
+
+// Link budget
+// A data line has one field per axis: padding and sign, the digits and the dot, then the separator
+// (the last separator is the newline). Every line is preceded by a time stamp line, and a sync line
+// is added once a second (see stamp.h), and up to urgent::MAX_RATE status lines (see urgent.h);
+// a memory line goes out every ram::PERIOD_SECONDS (see ram.h).
+// Byte counts are scaled by 100 to keep the sync share exact enough.
+constexpr uint32_t BITS_PER_BYTE = 10;  // Start + 8 data + stop
+constexpr uint32_t FIELD_LENGTH = 8 + (AXIS_DOT_POSITION < AXIS_DIGIT_COUNT ? 1 : 0) + 1;
+constexpr uint32_t LINE_LENGTH = AXIS_COUNT * FIELD_LENGTH;
+constexpr uint32_t FRAME_BYTES_X100 = (LINE_LENGTH + stamp::LINE_SIZE) * 100 +
+                                      (stamp::LINE_SIZE + urgent::MAX_RATE * urgent::LINE_SIZE) * 100 / FRAME_RATE +
+                                      (ram::LINE_SIZE - 1) * 100 / (FRAME_RATE * ram::PERIOD_SECONDS);
+
+// Share of the link used at FRAME_RATE, in per mille
+constexpr uint32_t LINK_LOAD_PERMILLE = FRAME_BYTES_X100 * BITS_PER_BYTE * FRAME_RATE * 10 / BAUDRATE;
+
+// Highest frame rate the link can carry
+constexpr uint32_t MAX_LINK_FRAME_RATE = BAUDRATE * 100 / BITS_PER_BYTE / FRAME_BYTES_X100;
+
+static_assert(LINE_LENGTH < BUFFER_SIZE, "Data line does not fit the line buffer");
+static_assert(TX_FRAME_SIZE <= TX_RING_SIZE, "Transmit ring does not hold a whole frame");
+static_assert(LINK_LOAD_PERMILLE <= 1000,
+              "Serial link budget exceeded: lower FRAME_RATE or AXIS_COUNT, or raise BAUDRATE");
 
 namespace transmitter {
 
-// Zero-terminated buffer for UART transmission
-//  - on emulator and transmitter mode, this buffer holds the data to be transmitted
-//  - on receiver mode, this buffer holds the received data
-volatile char tx_buffer[BUFFER_SIZE];
+// Bytes waiting for transmission
+//  - producer: transmit(), from the main loop or a timer ISR
+//  - consumer: data register empty interrupt
+irq::ring_buffer<char, TX_RING_SIZE> tx_buffer;
+
+// Number of messages dropped because the previous one was still being sent
+irq::atomic<uint16_t> dropped = 0;
 
-// Pointer to the current position in the buffer
-volatile char* buffer_ptr;
+// Urgent lines, sent ahead of tx_buffer at the next line boundary (see urgent.h)
+//  - producer: transmit_urgent(), from the main loop or an ISR
+//  - consumer: data register empty interrupt
+irq::ring_buffer<char, 16> urgent_buffer;
+urgent::scheduler scheduler;
 
 // Setup UART
-void init() {
-    // Initialize buffer pointer
-    buffer_ptr = nullptr;
+//  - the receiver may have set the rate already, the transmitter then shares it
+void init(const baud::setting& setting = BAUD) {
     // Set baud rate
-    UBRR0 = DIVIDER;
+    set_baud(setting);
     // Enable transmitter only
     UCSR0B |= static_cast<uint8_t>(1 << TXEN0);
     // Set frame format: 8 data bits, 1 stop bit
@@ -51,69 +118,120 @@ void init() {
 }
 
 ISR(USART_UDRE_vect) {
-    // Transmit next byte
-    UDR0 = static_cast<uint8_t>(*buffer_ptr++);
-    // If no more bytes to transmit, disable the data register empty interrupt and transmitter
-    if (*buffer_ptr == '\0') UCSR0B &= static_cast<uint8_t>(~_BV(UDRIE0));
+    load::probe<load::USART_UDRE> probe;
+    char c;
+    if (scheduler.next(urgent_buffer, tx_buffer, c)) {
+        // Transmit next byte
+        UDR0 = static_cast<uint8_t>(c);
+    } else {
+        // If no more bytes to transmit, disable the data register empty interrupt
+        UCSR0B &= static_cast<uint8_t>(~_BV(UDRIE0));
+    }
 }
 
 // Start buffer transmit
-//  - copy data to internal buffer
-//  - enable transmitter and data register empty interrupt
-void transmit(char* buf) {
+//  - the whole zero-terminated message is queued or, if it does not fit, dropped,
+//    so a partially sent message never appears on the line
+//  - enable data register empty interrupt
+//  - returns false if the message was dropped
+bool transmit(const char* buf) {
     // Ensure the buffer is not null
-    if (buf == nullptr) return;
+    if (buf == nullptr) return false;
 
     // If buffer is empty, do nothing
-    if (*buf == '\0') return;
+    size_t length = strlen(buf);
+    if (length == 0) return true;
 
-    // Copy data to buffer with zero-termination
-    for (size_t i = 0; i < sizeof(tx_buffer); i++) {
-        tx_buffer[i] = *buf++;
-        if (tx_buffer[i] == '\0') break;
+    // Drop the message if the previous one is not gone yet
+    if (length > tx_buffer.space()) {
+        dropped.store(static_cast<uint16_t>(dropped.load() + 1));
+        return false;
     }
 
-    // Initialize buffer pointer
-    buffer_ptr = tx_buffer;
+    // Queue the message
+    while (*buf) tx_buffer.push(*buf++);
 
-    // Transmit first byte
-    if (*buffer_ptr == '\0') return;             // Ensure the buffer is not empty
-    loop_until_bit_is_set(UCSR0A, UDRE0);        // Wait for transmit register to be empty
-    UDR0 = static_cast<uint8_t>(*buffer_ptr++);  // Load first byte into transmit register
+    // Transmit other bytes using interrupt
+    irq::critical_section lock;
+    UCSR0B |= static_cast<uint8_t>(_BV(UDRIE0));  // Enable data register empty interrupt
+    return true;
+}
 
-    // Transmit second byte
-    if (*buffer_ptr == '\0') return;             // Ensure the buffer is not empty
-    loop_until_bit_is_set(UCSR0A, UDRE0);        // Wait for transmit register to be empty
-    UDR0 = static_cast<uint8_t>(*buffer_ptr++);  // Load second byte into transmit register
+// Queue a diagnostic line if it fits behind what is queued, else leave it for a later call
+//  - never takes the room of a data line and is not counted as dropped
+//  - returns false if the line did not fit
+bool transmit_spare(const char* buf) {
+    if (strlen(buf) > tx_buffer.space()) return false;
+    return transmit(buf);
+}
 
-    // Transmit other bytes using interrupt
-    if (*buffer_ptr == '\0') return;              // Ensure the buffer is not empty
+// Queue an urgent line ahead of the other messages
+//  - the whole zero-terminated line is queued with interrupts masked, so the data register empty
+//    interrupt never sees half of it, or dropped if it does not fit
+//  - returns false if the line was dropped
+bool transmit_urgent(const char* buf) {
+    size_t length = strlen(buf);
+    irq::critical_section lock;
+    if (length > urgent_buffer.space()) return false;
+    while (*buf) urgent_buffer.push(*buf++);
     UCSR0B |= static_cast<uint8_t>(_BV(UDRIE0));  // Enable data register empty interrupt
+    return true;
 }
 
 }  // namespace transmitter
 
 namespace receiver {
 
-// Zero-terminated buffer for UART reception
-//  - on receiver mode, this buffer holds the received data
-//  - double buffer to allow processing one buffer while receiving into another
-volatile char buffer[2][BUFFER_SIZE];
-volatile uint8_t current_buffer = 0;
+// Bytes received but not yet consumed by the main loop
+//  - producer: receive complete interrupt
+//  - consumer: get_message()
+irq::ring_buffer<char, RX_RING_SIZE> rx_buffer;
 
-// Flag indicating if a complete message has been received
-volatile bool received_complete = false;
+// Number of bytes lost because the main loop did not keep up
+irq::atomic<uint16_t> overruns = 0;
 
-// Pointer to the current position in the buffer
-volatile uint8_t buffer_pos;
+// Number of bytes received without a stop bit, as at the wrong rate
+irq::atomic<uint16_t> framing_errors = 0;
 
-// Setup UART
-void init() {
-    // Initialize buffer pointer
-    current_buffer = 0;
-    buffer_pos = 0;
+// Uptime at the last newline received and the number of newlines so far, written by the ISR
+struct newline_t {
+    uint32_t time;
+    uint8_t count;
+};
+irq::seqlock<newline_t> last_newline;
+uint8_t newline_count = 0;
+
+// Newlines consumed by get_message()
+uint8_t lines_consumed = 0;
+
+// Uptime at the newline of the last message returned by get_message()
+// Only known if the main loop got to the message before the next one was complete
+uint32_t line_time = 0;
+bool line_time_valid = false;
+
+// Zero-terminated line assembled from rx_buffer, owned by the main loop
+char line[BUFFER_SIZE];
+
+// Position of the next character in line
+uint8_t line_pos = 0;
+
+// Set when the line is too long; the rest of it is skipped until the next newline
+bool line_overflow = false;
+
+// Rate the receiver runs at, BAUDRATE or the one detected at startup
+uint32_t rate = BAUDRATE;
+
+// Setup UART, called with interrupts masked when the rate changes while running
+void init(const baud::setting& setting = BAUD) {
+    // Drop what arrived at the old rate
+    rx_buffer.clear();
+    lines_consumed = newline_count;
+    // Initialize line position
+    line_pos = 0;
+    line_overflow = false;
     // Set baud rate
-    UBRR0 = DIVIDER;
+    rate = setting.rate;
+    set_baud(setting);
     // Enable receiver only & receive complete interrupt
     UCSR0B |= static_cast<uint8_t>(_BV(RXEN0) | _BV(RXCIE0));
     // Set frame format: 8 data bits, 1 stop bit
@@ -122,40 +240,51 @@ void init() {
 
 // USART Receive Complete interrupt
 ISR(USART_RX_vect) {
+    load::probe<load::USART_RX> probe;
+    // Status of the byte first, it goes with the read of UDR0
+    if (UCSR0A & _BV(FE0)) framing_errors.store(static_cast<uint16_t>(framing_errors.load() + 1));
+
     // Receive next byte
     char received = static_cast<char>(UDR0);
 
-    // Check if buffer is not full
-    if (buffer_pos < (BUFFER_SIZE - 1)) {
-        // Store received byte in buffer
-        buffer[current_buffer][buffer_pos++] = received;
-        return;
-    }
-
-    // If buffer is newline received, finalize the message
-    if (received == '\n') {
-        buffer[current_buffer][buffer_pos] = '\0';  // Null-terminate the string
-        current_buffer ^= 1;                        // Switch buffers
-        buffer_pos = 0;                             // Reset buffer position
-        received_complete = true;                   // Mark that a complete message has been received
+    // Store it for the main loop
+    if (!rx_buffer.push(received)) {
+        overruns.store(static_cast<uint16_t>(overruns.load() + 1));
+    } else if (received == '\n') {
+        last_newline.store({uptime::now(), ++newline_count});
     }
 }
 
 // Get the last received complete message
 //  - returns nullptr if no complete message is available
-//  - returns pointer to the message buffer otherwise
+//  - returns pointer to the message without the trailing newline otherwise
 //  - returned pointer is valid until next call to get_message()
-//  - resets the received_complete flag
+//  - line_time is set to the uptime at which the message was received, if line_time_valid
+//  - lines longer than the buffer are discarded
 inline char* get_message() {
-    char* msg = nullptr;
-    uint8_t sreg = SREG;
-    cli();
-    if (received_complete) {
-        received_complete = false;
-        msg = const_cast<char*>(buffer[current_buffer ^ 1]);
+    char received;
+    while (rx_buffer.pop(received)) {
+        // If newline received, finalize the message
+        if (received == '\n') {
+            newline_t newline = last_newline.load();
+            line_time = newline.time;
+            line_time_valid = newline.count == ++lines_consumed;
+            bool complete = !line_overflow && line_pos > 0;
+            line[line_pos] = '\0';  // Null-terminate the string
+            line_pos = 0;           // Reset line position
+            line_overflow = false;
+            if (complete) return line;
+            continue;
+        }
+
+        // Check if line is not full
+        if (line_pos < (BUFFER_SIZE - 1)) {
+            line[line_pos++] = received;
+        } else {
+            line_overflow = true;
+        }
     }
-    SREG = sreg;
-    return msg;
+    return nullptr;
 }
 
 }  // namespace receiver
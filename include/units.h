@@ -0,0 +1,129 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <stdint.h>
+
+#include "config.h"
+#include "flash.h"
+
+// Per-axis unit conversion and scaling of displayed values
+// Values are integer counts of the last displayed digit. A conversion is an exact rational
+// NUM / DEN, rounded to nearest with halves away from zero. The division by DEN is replaced by
+// a multiplication with a precomputed reciprocal, so converting costs one 32x32->64 bit multiply
+// and a shift per axis, without floats and without a division on the AVR.
+namespace units {
+
+// Largest magnitude to convert (7 digits, see AXIS_DIGIT_COUNT)
+constexpr uint32_t MAX_MAGNITUDE = 9999999;
+
+struct ratio {
+    uint32_t num;
+    uint32_t half;   // DEN / 2, added before the division for rounding
+    uint32_t magic;  // ceil(2^shift / DEN), 0 when DEN is 1
+    uint8_t shift;   // 32 or more, so only the high word of the product is needed
+    bool valid;
+};
+
+// Build a ratio at compile time
+// For n < 2^shift / (magic * DEN - 2^shift) the product n * magic >> shift equals n / DEN exactly;
+// shift is the smallest value that covers all numerators up to MAX_MAGNITUDE * NUM + DEN / 2.
+constexpr ratio make_ratio(uint32_t num, uint32_t den) {
+    ratio r{num, den / 2, 0, 32, false};
+    if (num == 0 || den == 0 || num > UINT32_MAX / MAX_MAGNITUDE - 1) return r;
+    if (den == 1) {
+        r.valid = true;
+        return r;
+    }
+    uint64_t n_max = static_cast<uint64_t>(MAX_MAGNITUDE) * num + den / 2;
+    for (uint8_t shift = 32; shift < 64; shift++) {
+        uint64_t power = static_cast<uint64_t>(1) << shift;
+        uint64_t magic = (power + den - 1) / den;
+        if (magic > UINT32_MAX) break;
+        uint64_t error = magic * den - power;
+        if (error == 0 || n_max < power / error) {
+            r.magic = static_cast<uint32_t>(magic);
+            r.shift = shift;
+            r.valid = true;
+            break;
+        }
+    }
+    return r;
+}
+
+// round(value * NUM / DEN), halves away from zero; |value| must not exceed MAX_MAGNITUDE
+inline int32_t scale(int32_t value, const ratio& r) {
+    uint32_t magnitude = static_cast<uint32_t>(value < 0 ? -value : value);
+    uint32_t n = magnitude * r.num + r.half;
+    uint32_t q = n;
+    if (r.magic != 0) {
+        uint32_t high = static_cast<uint32_t>((static_cast<uint64_t>(n) * r.magic) >> 32);
+        q = high >> (r.shift - 32);
+    }
+    return value < 0 ? -static_cast<int32_t>(q) : static_cast<int32_t>(q);
+}
+
+// Inch mode shows one more decimal when an integer digit can be spared:
+// counts of 10^-f mm become counts of 10^-(f+1) inch
+template <int AXIS_DOT_POSITION_T>
+struct inch {
+    static constexpr bool EXTRA_DIGIT = AXIS_DOT_POSITION_T >= 2;
+    static constexpr int DOT_POSITION = EXTRA_DIGIT ? AXIS_DOT_POSITION_T - 1 : AXIS_DOT_POSITION_T;
+    static constexpr uint32_t NUM = EXTRA_DIGIT ? 50 : 5;  // 1 / 25.4 = 5 / 127
+};
+constexpr bool INCH_EXTRA_DIGIT = inch<AXIS_DOT_POSITION>::EXTRA_DIGIT;
+constexpr int INCH_DOT_POSITION = inch<AXIS_DOT_POSITION>::DOT_POSITION;
+constexpr uint32_t INCH_NUM = inch<AXIS_DOT_POSITION>::NUM;
+constexpr uint32_t INCH_DEN = 127;
+
+// Largest count shown with a number of digits
+constexpr int32_t max_count(int digits) {
+    int32_t max = 1;
+    for (int i = 0; i < digits; i++) max *= 10;
+    return max - 1;
+}
+
+// Conversion modes, combined as flags
+enum mode_t : uint8_t {
+    MM = 0,
+    INCH = 1 << 0,      // Show inches instead of millimetres
+    DIAMETER = 1 << 1,  // Show the diameter of a lathe X axis that reports the radius
+    MODE_COUNT = 4,
+};
+
+// In flash, read with flash::read(); the first index is inch<>::EXTRA_DIGIT
+constexpr ratio RATIOS[2][MODE_COUNT] PROGMEM = {
+    {make_ratio(1, 1), make_ratio(inch<0>::NUM, INCH_DEN), make_ratio(2, 1), make_ratio(2 * inch<0>::NUM, INCH_DEN)},
+    {make_ratio(1, 1), make_ratio(inch<2>::NUM, INCH_DEN), make_ratio(2, 1), make_ratio(2 * inch<2>::NUM, INCH_DEN)},
+};
+
+static_assert(RATIOS[0][INCH].valid && RATIOS[0][INCH | DIAMETER].valid && RATIOS[1][INCH].valid &&
+                  RATIOS[1][INCH | DIAMETER].valid,
+              "Conversion ratio out of range");
+
+// Convert all axes, clamping the result to the displayable range of the layout
+template <int AXIS_DIGIT_COUNT_T = AXIS_DIGIT_COUNT, int AXIS_DOT_POSITION_T = AXIS_DOT_POSITION, size_t AXIS_COUNT_T>
+void convert(int32_t (&axis)[AXIS_COUNT_T], const uint8_t (&modes)[AXIS_COUNT_T]) {
+    constexpr int32_t max = max_count(AXIS_DIGIT_COUNT_T);
+    const ratio* ratios = RATIOS[inch<AXIS_DOT_POSITION_T>::EXTRA_DIGIT];
+    for (uint8_t i = 0; i < AXIS_COUNT_T; i++) {
+        int32_t value = scale(axis[i], flash::read(&ratios[modes[i] & (MODE_COUNT - 1)]));
+        if (value > max) value = max;
+        if (value < -max) value = -max;
+        axis[i] = value;
+    }
+}
+
+}  // namespace units
@@ -0,0 +1,59 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+#include "config.h"
+#include "irq.h"
+#include "load.h"
+
+// Free-running 32 bit clock on Timer1
+// One tick is 0.5 us (F_CPU / 8), the clock wraps after about 35 minutes,
+// so compare times only through unsigned differences.
+namespace uptime {
+
+constexpr uint32_t TICKS_PER_SECOND = F_CPU / 8;
+constexpr uint32_t TICKS_PER_US = TICKS_PER_SECOND / 1000000;
+
+// High half of the clock, incremented by the overflow interrupt
+volatile uint16_t overflows = 0;
+
+inline void init() {
+    TCCR1A = 0;
+    TCCR1B = 0;
+    TCNT1 = 0;
+    TCCR1B = _BV(CS11);    // Normal mode, prescaler 8
+    TIMSK1 = _BV(TOIE1);  // Enable Timer1 overflow interrupt
+}
+
+// Current time in ticks, callable from the main loop and from interrupts
+inline uint32_t now() {
+    irq::critical_section lock;
+    uint16_t low = TCNT1;
+    uint16_t high = overflows;
+    // Overflow happened after interrupts were disabled, but not yet counted
+    if ((TIFR1 & _BV(TOV1)) && low < 0x8000) high++;
+    return (static_cast<uint32_t>(high) << 16) | low;
+}
+
+// Timer1 overflow interrupt handler
+ISR(TIMER1_OVF_vect) {
+    load::probe<load::TIMER1> probe;
+    overflows = static_cast<uint16_t>(overflows + 1);
+}
+
+}  // namespace uptime
@@ -0,0 +1,92 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bus.h"
+#include "config.h"
+#include "stamp.h"
+
+// Urgent lines: NCU status (ER, A7) on the serial link
+//   !<s><hex>  status s ('0'..'3': bit 0 ER, bit 1 A7 active) since sender uptime <hex>
+// The transmitter queues one whenever the status changes, and repeats the status, active or not,
+// every second for a receiver started later or one that lost a line. An urgent line jumps ahead of
+// the queued lines at the next line boundary, so it waits for one line at most (see scheduler below).
+namespace urgent {
+
+constexpr char PREFIX = '!';
+
+// Status lines per second at most, repeats included: a status line follows the previous one after
+// 1 / MAX_RATE seconds at the earliest, so a chattering ER or A7 input cannot flood the link. A
+// change within that gap goes out when it ends. The link budget counts MAX_RATE lines a second.
+constexpr uint8_t MAX_RATE = 4;
+
+constexpr uint8_t ER = 0x01;
+constexpr uint8_t A7 = 0x02;
+
+// "!" + status + 8 hex digits + newline, the layout of a stamp line
+constexpr size_t LINE_SIZE = stamp::LINE_SIZE;
+
+// Active status flags from a port D image
+constexpr uint8_t status_of(uint8_t pind) {
+    return static_cast<uint8_t>(((pind ^ BUS_STATUS_INVERT) & bus::STATUS_MASK) >> 6);
+}
+
+// Port D image of status flags
+constexpr uint8_t pins_of(uint8_t status) {
+    return static_cast<uint8_t>(((status << 6) ^ BUS_STATUS_INVERT) & bus::STATUS_MASK);
+}
+
+// Write a status line, returns the position after the newline (not zero-terminated)
+inline char* write(char* out, uint8_t status, uint32_t time) {
+    char* end = stamp::write(out, static_cast<char>('0' + (status & (ER | A7))), time);
+    out[0] = PREFIX;
+    return end;
+}
+
+// Parse a line without the newline
+// Returns false if it is not a status line
+inline bool parse(const char* line, uint8_t& status, uint32_t& time) {
+    if (line[0] != PREFIX || line[1] < '0' || line[1] > '3') return false;
+    status = static_cast<uint8_t>(line[1] - '0');
+    return stamp::parse_hex(line + 2, time);
+}
+
+// Picks the next byte for the wire from the urgent and the normal queue
+// An urgent line starts only after a newline (or on an idle link) and then goes out whole,
+// so lines are never mixed. The urgent line must be queued in one go, with interrupts masked.
+class scheduler {
+   public:
+    template <typename Urgent, typename Normal>
+    bool next(Urgent& urgent, Normal& normal, char& c) {
+        bool got = false;
+        if (boundary || in_urgent) {
+            got = urgent.pop(c);
+            in_urgent = got && c != '\n';
+        }
+        if (!got) got = normal.pop(c);
+        if (got) boundary = c == '\n';
+        return got;
+    }
+
+   private:
+    bool boundary = true;
+    bool in_urgent = false;
+};
+
+}  // namespace urgent
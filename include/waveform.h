@@ -0,0 +1,97 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+#include "bus.h"
+#include "config.h"
+#include "irq.h"
+#include "load.h"
+
+// Razmer 2M bus waveform output (emulator only)
+// Timer2 ticks the bus scanner and drives W1..W8, ER, A7 (PD2..PD7) and B0..B5 (PC0..PC5)
+namespace waveform {
+
+// Timer2 runs at F_CPU / 32 = 2 us per count
+constexpr uint32_t TIMER_HZ = F_CPU / 32;
+
+// Shortest tick the ISR can keep up with
+constexpr uint8_t MIN_COMPARE = 4;
+
+using frame_t = bus::frame<>;
+
+// Frames to put on the bus, prepared by the main loop
+irq::double_buffer<frame_t> frames;
+
+// Waveform state, owned by the ISR
+bus::scanner<> scanner;
+
+// Port images for the next tick, computed one tick ahead so the ISR can output them
+// first thing, with constant latency
+uint8_t next_portd = 0;
+uint8_t next_portc = bus::IDLE;
+
+// Pins not driven by the waveform keep their USART function (PD0, PD1)
+constexpr uint8_t PORTD_KEEP = _BV(PD0) | _BV(PD1);
+
+// Set the slot period (setup + strobe + hold) in microseconds
+// Returns the period actually set, limited by the timer range and ISR duration
+inline uint16_t set_slot_period(uint16_t us) {
+    uint32_t counts = static_cast<uint32_t>(us) * (TIMER_HZ / 1000) / 1000 / bus::scanner<>::TICKS_PER_SLOT;
+    if (counts < MIN_COMPARE + 1u) counts = MIN_COMPARE + 1u;
+    if (counts > 256) counts = 256;
+    OCR2A = static_cast<uint8_t>(counts - 1);
+    return static_cast<uint16_t>(counts * bus::scanner<>::TICKS_PER_SLOT * 1000 / (TIMER_HZ / 1000));
+}
+
+// Inject a spike on the B lines every N slots (0 = off)
+// Single byte settings are picked up by the ISR without locking
+inline void set_glitch_interval(uint8_t slots) { scanner.glitch_interval = slots; }
+
+// Set ER and A7 levels (bus::ER_MASK, bus::A7_MASK)
+inline void set_status(uint8_t status) { scanner.status = status; }
+
+inline void init() {
+    // Idle bus
+    PORTC = (PORTC & static_cast<uint8_t>(~bus::B_MASK)) | bus::IDLE;
+
+    // Reset
+    TCCR2A = 0;
+    TCCR2B = 0;
+    TCNT2 = 0;
+
+    set_slot_period(BUS_SLOT_PERIOD_US);
+    set_glitch_interval(BUS_GLITCH_INTERVAL);
+
+    TCCR2A = _BV(WGM21);              // Set CTC mode
+    TCCR2B = _BV(CS21) | _BV(CS20);   // Set prescaler to 32
+    TIMSK2 = _BV(OCIE2A);             // Enable Timer2 compare interrupt
+}
+
+// Timer2 interrupt handler
+ISR(TIMER2_COMPA_vect) {
+    load::probe<load::TIMER2> probe;
+    // Output first, so the edges do not depend on the path taken below
+    PORTC = next_portc;
+    PORTD = static_cast<uint8_t>(next_portd | (PORTD & PORTD_KEEP));
+
+    // Prepare the next tick
+    if (scanner.tick(next_portd, next_portc)) scanner.load(frames.front());
+}
+
+}  // namespace waveform
@@ -0,0 +1,328 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// Host benchmarks of the code on the data path: formatting, segment encoding, line parsing,
+// bus encode/decode and the diagnostic lines. Every benchmark runs over the input patterns the
+// emulator produces, since format() and the decoder take value dependent paths.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include "bus.h"
+#include "fast_parse.h"
+#include "format.h"
+#include "parse.h"
+#include "segments.h"
+#include "stamp.h"
+#include "units.h"
+
+namespace {
+
+// Input patterns, as generated by the emulator
+enum pattern_t { RANDOM, INCREMENTING, UNCHANGED };
+const char* const PATTERN_NAMES[] = {"random", "incrementing", "unchanged"};
+
+// Frames per input set, a power of two so the benchmarks wrap with a mask
+constexpr size_t FRAMES = 1024;
+
+template <size_t N, int D>
+struct axes_t {
+    int64_t value[N];
+};
+
+// Input frames for a pattern
+// UNCHANGED repeats the last frame and moves one axis by one count every 50 frames
+template <size_t N, int D>
+std::vector<axes_t<N, D>> make_frames(pattern_t pattern) {
+    int64_t max = 1;
+    for (int i = 0; i < D; i++) max *= 10;
+    max -= 1;
+
+    std::mt19937_64 rng(2025);
+    std::uniform_int_distribution<int64_t> dist(-max, max);
+    std::vector<axes_t<N, D>> frames(FRAMES);
+    axes_t<N, D> current;
+    for (auto& v : current.value) v = dist(rng);
+    for (size_t i = 0; i < FRAMES; i++) {
+        switch (pattern) {
+            case RANDOM:
+                for (auto& v : current.value) v = dist(rng);
+                break;
+            case INCREMENTING:
+                for (auto& v : current.value) v = v < max ? v + 1 : -max;
+                break;
+            case UNCHANGED:
+                if (i % 50 == 0) current.value[(i / 50) % N] += 1;
+                break;
+        }
+        frames[i] = current;
+    }
+    return frames;
+}
+
+// Data lines for a pattern, as the receiver gets them
+template <size_t N, int D, int P>
+std::vector<std::string> make_lines(pattern_t pattern) {
+    std::vector<std::string> lines;
+    char buffer[N * 10 + 1];
+    for (auto& frame : make_frames<N, D>(pattern)) lines.emplace_back(format<N, D, P>(frame.value, buffer));
+    return lines;
+}
+
+pattern_t pattern_of(const benchmark::State& state) { return static_cast<pattern_t>(state.range(0)); }
+
+template <size_t N, int D, int P>
+void BM_Format(benchmark::State& state) {
+    auto frames = make_frames<N, D>(pattern_of(state));
+    char buffer[N * 10 + 1];
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(format<N, D, P>(frames[i++ & (FRAMES - 1)].value, buffer));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(PATTERN_NAMES[pattern_of(state)]);
+}
+
+// The same frames through the 32-bit subtraction engine the receiver renders with
+template <size_t N, int D, int P>
+void BM_Format32(benchmark::State& state) {
+    std::vector<std::array<int32_t, N>> frames;
+    for (auto& frame : make_frames<N, D>(pattern_of(state))) {
+        std::array<int32_t, N> narrow;
+        for (size_t j = 0; j < N; j++) narrow[j] = static_cast<int32_t>(frame.value[j]);
+        frames.push_back(narrow);
+    }
+    char buffer[N * 10 + 1];
+    int32_t axis[N];
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& frame = frames[i++ & (FRAMES - 1)];
+        std::copy(frame.begin(), frame.end(), axis);
+        benchmark::DoNotOptimize(format<N, D, P>(axis, buffer));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(PATTERN_NAMES[pattern_of(state)]);
+}
+
+template <size_t N, int D, int P>
+void BM_Parse(benchmark::State& state) {
+    auto lines = make_lines<N, D, P>(pattern_of(state));
+    int32_t axis[N];
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parse<N, D, P>(lines[i++ & (FRAMES - 1)].c_str(), axis));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(PATTERN_NAMES[pattern_of(state)]);
+}
+
+// A data line to display buffer bytes, as display::write() does it
+template <size_t N, int D, int P>
+void BM_Segments(benchmark::State& state) {
+    auto lines = make_lines<N, D, P>(pattern_of(state));
+    uint8_t segments[N * 10];
+    size_t i = 0;
+    for (auto _ : state) {
+        const std::string& line = lines[i++ & (FRAMES - 1)];
+        for (size_t j = 0; j < line.size(); j++) segments[j] = segment_from_ascii(line[j]);
+        benchmark::DoNotOptimize(segments);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(lines[0].size()));
+    state.SetLabel(PATTERN_NAMES[pattern_of(state)]);
+}
+
+template <size_t N, int D>
+void BM_BusEncode(benchmark::State& state) {
+    auto frames = make_frames<N, D>(pattern_of(state));
+    bus::frame<N, D> frame;
+    size_t i = 0;
+    for (auto _ : state) {
+        bus::encode(frames[i++ & (FRAMES - 1)].value, frame);
+        benchmark::DoNotOptimize(frame);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(PATTERN_NAMES[pattern_of(state)]);
+}
+
+template <size_t N, int D>
+void BM_BusDecode(benchmark::State& state) {
+    std::vector<bus::frame<N, D>> encoded(FRAMES);
+    auto frames = make_frames<N, D>(pattern_of(state));
+    for (size_t i = 0; i < FRAMES; i++) bus::encode(frames[i].value, encoded[i]);
+    int64_t axis[N];
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(bus::decode(encoded[i++ & (FRAMES - 1)], axis));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(PATTERN_NAMES[pattern_of(state)]);
+}
+
+// Pin change samples of whole frames through the transmitter decoder, items are samples
+template <size_t N, int D>
+void BM_BusSample(benchmark::State& state) {
+    using scanner_t = bus::scanner<N, D>;
+    auto frames = make_frames<N, D>(pattern_of(state));
+
+    // Record the port images of the waveform once, one frame after the other
+    std::vector<uint8_t> pind, pinc;
+    scanner_t scanner;
+    bus::frame<N, D> frame;
+    bus::encode(frames[0].value, frame);
+    scanner.load(frame);
+    uint8_t portd = 0, portc = bus::IDLE;
+    for (size_t i = 1; i < FRAMES;) {
+        if (scanner.tick(portd, portc)) {
+            bus::encode(frames[i++].value, frame);
+            scanner.load(frame);
+        }
+        pind.push_back(portd);
+        pinc.push_back(portc);
+    }
+
+    bus::decoder<N, D> decoder;
+    for (auto _ : state) {
+        for (size_t i = 0; i < pind.size(); i++) benchmark::DoNotOptimize(decoder.sample(pind[i], pinc[i]));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(pind.size()));
+    state.SetLabel(PATTERN_NAMES[pattern_of(state)]);
+}
+
+void BM_StampWrite(benchmark::State& state) {
+    char line[stamp::LINE_SIZE];
+    uint32_t time = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(stamp::write(line, stamp::TIME, time += 40000));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_StampParse(benchmark::State& state) {
+    std::vector<std::string> lines;
+    char line[stamp::LINE_SIZE];
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        *(stamp::write(line, stamp::TIME, i * 40000) - 1) = '\0';
+        lines.emplace_back(line);
+    }
+    char tag;
+    uint32_t value;
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(stamp::parse(lines[i++ & (FRAMES - 1)].c_str(), tag, value));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Inch conversion of one line of axis values, the first axis as diameter
+void BM_UnitsConvert(benchmark::State& state) {
+    auto frames = make_frames<AXIS_COUNT, AXIS_DIGIT_COUNT>(pattern_of(state));
+    uint8_t modes[AXIS_COUNT];
+    for (auto& mode : modes) mode = units::INCH;
+    modes[0] |= units::DIAMETER;
+    int32_t axis[AXIS_COUNT];
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& frame = frames[i++ & (FRAMES - 1)];
+        for (size_t j = 0; j < AXIS_COUNT; j++) axis[j] = static_cast<int32_t>(frame.value[j]);
+        units::convert(axis, modes);
+        benchmark::DoNotOptimize(axis);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(PATTERN_NAMES[pattern_of(state)]);
+}
+
+// A capture buffer through the host parser, one instruction set per argument, bytes are the capture
+template <size_t N, int D, int P>
+void BM_FastParse(benchmark::State& state) {
+    const auto which = static_cast<fast_parse::isa>(state.range(0));
+    if (which > fast_parse::detect()) {
+        state.SkipWithError("instruction set not supported");
+        return;
+    }
+    std::string buffer;
+    for (int i = 0; i < 16; i++)
+        for (auto& line : make_lines<N, D, P>(RANDOM)) buffer += line;
+
+    const fast_parse::parser<N, D, P> parser(which);
+    int64_t sum = 0;
+    for (auto _ : state) {
+        parser.parse(buffer.data(), buffer.data() + buffer.size(), [&](const int32_t (&axis)[N]) { sum += axis[0]; });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(buffer.size()));
+    state.SetLabel(fast_parse::name(which));
+}
+
+void instruction_sets(benchmark::internal::Benchmark* b) {
+    b->ArgName("isa");
+    for (auto which : {fast_parse::isa::SCALAR, fast_parse::isa::SSE2, fast_parse::isa::AVX2}) {
+        b->Arg(static_cast<int>(which));
+    }
+}
+
+// Every benchmark over every input pattern
+void patterns(benchmark::internal::Benchmark* b) {
+    b->ArgName("pattern");
+    for (int p = RANDOM; p <= UNCHANGED; p++) b->Arg(p);
+}
+
+}  // namespace
+
+// Default configuration, the smallest and the largest line, and the dot at both ends
+BENCHMARK_TEMPLATE(BM_Format, AXIS_COUNT, AXIS_DIGIT_COUNT, AXIS_DOT_POSITION)->Apply(patterns);
+BENCHMARK_TEMPLATE(BM_Format, 1, 1, 1)->Apply(patterns);
+BENCHMARK_TEMPLATE(BM_Format, 5, 7, 4)->Apply(patterns);
+BENCHMARK_TEMPLATE(BM_Format, 4, 6, 0)->Apply(patterns);
+BENCHMARK_TEMPLATE(BM_Format, 4, 6, 6)->Apply(patterns);
+
+BENCHMARK_TEMPLATE(BM_Format32, AXIS_COUNT, AXIS_DIGIT_COUNT, AXIS_DOT_POSITION)->Apply(patterns);
+BENCHMARK_TEMPLATE(BM_Format32, 1, 1, 1)->Apply(patterns);
+BENCHMARK_TEMPLATE(BM_Format32, 5, 7, 4)->Apply(patterns);
+BENCHMARK_TEMPLATE(BM_Format32, 4, 6, 0)->Apply(patterns);
+BENCHMARK_TEMPLATE(BM_Format32, 4, 6, 6)->Apply(patterns);
+
+BENCHMARK_TEMPLATE(BM_Parse, AXIS_COUNT, AXIS_DIGIT_COUNT, AXIS_DOT_POSITION)->Apply(patterns);
+BENCHMARK_TEMPLATE(BM_Parse, 5, 7, 4)->Apply(patterns);
+
+BENCHMARK_TEMPLATE(BM_FastParse, AXIS_COUNT, AXIS_DIGIT_COUNT, AXIS_DOT_POSITION)->Apply(instruction_sets);
+BENCHMARK_TEMPLATE(BM_FastParse, 5, 7, 4)->Apply(instruction_sets);
+
+BENCHMARK_TEMPLATE(BM_Segments, AXIS_COUNT, AXIS_DIGIT_COUNT, AXIS_DOT_POSITION)->Apply(patterns);
+
+BENCHMARK_TEMPLATE(BM_BusEncode, AXIS_COUNT, AXIS_DIGIT_COUNT)->Apply(patterns);
+BENCHMARK_TEMPLATE(BM_BusDecode, AXIS_COUNT, AXIS_DIGIT_COUNT)->Apply(patterns);
+BENCHMARK_TEMPLATE(BM_BusSample, AXIS_COUNT, AXIS_DIGIT_COUNT)->Apply(patterns);
+
+BENCHMARK(BM_StampWrite);
+BENCHMARK(BM_StampParse);
+BENCHMARK(BM_UnitsConvert)->Apply(patterns);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,182 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "archive.h"
+
+namespace {
+
+constexpr archive::layout LINES = {3, 6, 4};
+
+std::string temp_path(const char* name) { return testing::TempDir() + name; }
+
+// 50 frames per second with a little jitter; axis 0 moves, axis 1 wanders by one count, axis 2 stands still
+std::vector<archive::frame> make_frames(size_t count, int64_t start_us) {
+    std::mt19937 rng(7);
+    std::vector<archive::frame> frames(count);
+    int64_t time = start_us;
+    for (size_t i = 0; i < count; i++) {
+        archive::frame& f = frames[i];
+        f.time_us = time;
+        f.axis[0] = static_cast<int32_t>(i * 3 % 100000);
+        f.axis[1] = 1234 + static_cast<int32_t>(rng() % 3) - 1;
+        f.axis[2] = -999999;
+        time += 20000 + static_cast<int64_t>(rng() % 41) - 20;
+    }
+    return frames;
+}
+
+bool write(const std::string& path, const std::vector<archive::frame>& frames, bool append = false) {
+    archive::writer writer;
+    std::string error;
+    bool ok = append ? writer.append(path.c_str(), LINES, error) : writer.create(path.c_str(), LINES, error);
+    for (size_t i = 0; ok && i < frames.size(); i++) ok = writer.add(frames[i], error);
+    ok = ok && writer.close(error);
+    EXPECT_TRUE(ok) << error;
+    return ok;
+}
+
+std::vector<archive::frame> read(const archive::reader& reader, int64_t from, int64_t to, size_t* decoded = nullptr) {
+    std::vector<archive::frame> frames;
+    std::string error;
+    EXPECT_TRUE(reader.query(from, to, [&](const archive::frame& f) { frames.push_back(f); }, error, decoded))
+        << error;
+    return frames;
+}
+
+void expect_frames(const std::vector<archive::frame>& out, const archive::frame* in, size_t count) {
+    ASSERT_EQ(out.size(), count);
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_EQ(out[i].time_us, in[i].time_us) << i;
+        for (size_t j = 0; j < LINES.axes; j++) ASSERT_EQ(out[i].axis[j], in[i].axis[j]) << i << " " << j;
+    }
+}
+
+}  // namespace
+
+TEST(ArchiveTest, ColumnRoundTrip) {
+    std::mt19937_64 rng(1);
+    std::vector<int64_t> values = {INT32_MIN, INT32_MAX, 0, 0, 0, 5, 10, 15, 20, -7};
+    int64_t walk = 0;
+    for (int i = 0; i < 10000; i++) values.push_back(walk += static_cast<int64_t>(rng() % 7) - 3);
+    values.push_back(int64_t(1) << 52);
+
+    std::vector<uint8_t> encoded;
+    archive::encode_column(values, encoded);
+    std::vector<int64_t> decoded(values.size());
+    const uint32_t count = static_cast<uint32_t>(values.size());
+    ASSERT_TRUE(archive::decode_column(encoded.data(), encoded.data() + encoded.size(), count, decoded.data()));
+    EXPECT_EQ(decoded, values);
+
+    // One value more or less than encoded is an error
+    EXPECT_FALSE(archive::decode_column(encoded.data(), encoded.data() + encoded.size(), count + 1, decoded.data()));
+    EXPECT_FALSE(archive::decode_column(encoded.data(), encoded.data() + encoded.size(), count - 1, decoded.data()));
+}
+
+TEST(ArchiveTest, SteadyColumnsAreRuns) {
+    // Still, and moving at a constant rate: the first value, one difference and a run
+    std::vector<int64_t> still(archive::BLOCK_FRAMES, 4321), moving(archive::BLOCK_FRAMES);
+    for (size_t i = 0; i < moving.size(); i++) moving[i] = static_cast<int64_t>(i) * 20000;
+    std::vector<uint8_t> a, b;
+    archive::encode_column(still, a);
+    archive::encode_column(moving, b);
+    EXPECT_LE(a.size(), 4u);
+    EXPECT_LE(b.size(), 6u);
+}
+
+TEST(ArchiveTest, QueryDecodesOnlyTheRange) {
+    const std::string path = temp_path("query.r2m");
+    const auto frames = make_frames(archive::BLOCK_FRAMES * 5 + 100, 1000000);
+    ASSERT_TRUE(write(path, frames));
+
+    archive::reader reader;
+    std::string error;
+    ASSERT_TRUE(reader.open(path.c_str(), error)) << error;
+    EXPECT_EQ(reader.lines().axes, LINES.axes);
+    EXPECT_EQ(reader.blocks().size(), 6u);
+    EXPECT_EQ(reader.frames(), frames.size());
+    expect_frames(read(reader, INT64_MIN, INT64_MAX), frames.data(), frames.size());
+
+    // A few frames inside the third block, then a range across the fourth and fifth block
+    size_t decoded;
+    const size_t a = archive::BLOCK_FRAMES * 2 + 10;
+    const size_t b = archive::BLOCK_FRAMES * 3 + 5, c = archive::BLOCK_FRAMES * 4 + 7;
+    expect_frames(read(reader, frames[a].time_us, frames[a + 20].time_us, &decoded), &frames[a], 20);
+    EXPECT_EQ(decoded, 1u);
+    expect_frames(read(reader, frames[b].time_us, frames[c].time_us, &decoded), &frames[b], c - b);
+    EXPECT_EQ(decoded, 2u);
+
+    // Before and after the archive
+    EXPECT_TRUE(read(reader, 0, frames[0].time_us, &decoded).empty());
+    EXPECT_EQ(decoded, 0u);
+    EXPECT_TRUE(read(reader, frames.back().time_us + 1, INT64_MAX, &decoded).empty());
+    EXPECT_EQ(decoded, 0u);
+}
+
+TEST(ArchiveTest, AppendContinuesTheArchive) {
+    const std::string path = temp_path("append.r2m");
+    const auto frames = make_frames(10000, 0);
+    const std::vector<archive::frame> first(frames.begin(), frames.begin() + 6000);
+    const std::vector<archive::frame> second(frames.begin() + 6000, frames.end());
+    ASSERT_TRUE(write(path, first));
+    ASSERT_TRUE(write(path, second, true));
+
+    archive::reader reader;
+    std::string error;
+    ASSERT_TRUE(reader.open(path.c_str(), error)) << error;
+    expect_frames(read(reader, INT64_MIN, INT64_MAX), frames.data(), frames.size());
+
+    // Time must not go back across the append
+    archive::writer writer;
+    ASSERT_TRUE(writer.append(path.c_str(), LINES, error)) << error;
+    EXPECT_FALSE(writer.add(frames[0], error));
+    EXPECT_EQ(error, "frame time goes back");
+
+    // Lines of another layout must not be appended
+    archive::writer other;
+    EXPECT_FALSE(other.append(path.c_str(), {LINES.axes, LINES.digits, 0}, error));
+    EXPECT_EQ(error, path + " holds lines of another layout");
+}
+
+TEST(ArchiveTest, DamageIsReported) {
+    const std::string path = temp_path("damaged.r2m");
+    ASSERT_TRUE(write(path, make_frames(5000, 0)));
+    std::string error;
+    {
+        // A token of the first block that runs past its column
+        FILE* file = fopen(path.c_str(), "r+b");
+        ASSERT_NE(file, nullptr);
+        fseek(file, archive::HEADER_SIZE + 8, SEEK_SET);
+        fputc(0xFF, file);
+        fclose(file);
+        archive::reader reader;
+        ASSERT_TRUE(reader.open(path.c_str(), error)) << error;
+        EXPECT_FALSE(reader.query(INT64_MIN, INT64_MAX, [](const archive::frame&) {}, error));
+        EXPECT_EQ(error, "damaged block at offset 16");
+    }
+    {
+        // Cut off: no footer
+        ASSERT_EQ(truncate(path.c_str(), 1000), 0);
+        archive::reader reader;
+        EXPECT_FALSE(reader.open(path.c_str(), error));
+        EXPECT_EQ(error, path + " is not an archive");
+    }
+}
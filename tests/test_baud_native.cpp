@@ -0,0 +1,131 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "baud.h"
+
+namespace {
+
+constexpr uint32_t F_16MHZ = 16000000;
+
+// Error of a setting computed in floating point
+double error_bp(uint32_t f_cpu, const baud::setting& s) {
+    double actual = static_cast<double>(f_cpu) / ((s.u2x ? 8.0 : 16.0) * (s.ubrr + 1));
+    return (actual / s.rate - 1.0) * 10000.0;
+}
+
+}  // namespace
+
+TEST(BaudTest, KnownRatesAt16MHz) {
+    constexpr baud::setting b38400 = baud::solve(F_16MHZ, 38400);
+    static_assert(b38400.valid && !b38400.u2x && b38400.ubrr == 25, "38400 baud");
+    EXPECT_EQ(b38400.error_bp, 16);
+
+    const baud::setting b57600 = baud::solve(F_16MHZ, 57600);
+    EXPECT_TRUE(b57600.valid);
+    EXPECT_TRUE(b57600.u2x);
+    EXPECT_EQ(b57600.ubrr, 34);
+
+    // 2.1 % at best
+    EXPECT_FALSE(baud::solve(F_16MHZ, 115200).valid);
+
+    // Exact high rates
+    const uint32_t exact[] = {250000, 500000, 1000000, 2000000};
+    for (uint32_t rate : exact) {
+        const baud::setting s = baud::solve(F_16MHZ, rate);
+        EXPECT_TRUE(s.valid) << rate;
+        EXPECT_EQ(s.error_bp, 0) << rate;
+    }
+    EXPECT_TRUE(baud::solve(F_16MHZ, 2000000).u2x);
+    EXPECT_EQ(baud::solve(F_16MHZ, 1000000).ubrr, 0);
+
+    // Too slow for the 12 bit divider in either mode
+    EXPECT_FALSE(baud::solve(F_16MHZ, 200).valid);
+}
+
+TEST(BaudTest, SolverPicksTheSmallestError) {
+    const uint32_t clocks[] = {1000000, 8000000, 14745600, 16000000, 20000000};
+    for (uint32_t f_cpu : clocks) {
+        for (uint32_t rate = 300; rate <= 2500000; rate += rate / 50 + 1) {
+            const baud::setting s = baud::solve(f_cpu, rate);
+            if (s.error_bp == INT32_MAX) continue;
+            ASSERT_LE(s.ubrr, 4095);
+            ASSERT_NEAR(s.error_bp, error_bp(f_cpu, s), 1.0) << f_cpu << " " << rate;
+            ASSERT_EQ(s.valid, std::abs(s.error_bp) <= baud::MAX_ERROR_BP);
+
+            // No divider of either mode does better
+            for (uint8_t mode = 0; mode < 2; mode++) {
+                for (uint32_t ubrr = 0; ubrr < 4096; ubrr++) {
+                    double actual = static_cast<double>(f_cpu) / ((mode ? 8.0 : 16.0) * (ubrr + 1));
+                    double other = std::abs((actual / rate - 1.0) * 10000.0);
+                    ASSERT_GE(other + 1.0, std::abs(error_bp(f_cpu, s))) << f_cpu << " " << rate << " " << ubrr;
+                }
+            }
+        }
+    }
+}
+
+TEST(BaudTest, CrystalForStandardRates) {
+    EXPECT_EQ(baud::solve(14745600, 115200).error_bp, 0);
+    EXPECT_EQ(baud::solve(14745600, 230400).error_bp, 0);
+}
+
+TEST(BaudTest, FastestRate) {
+    static_assert(baud::fastest(F_16MHZ) == 1000000, "16 MHz divides down to 1 Mbaud");
+    EXPECT_EQ(baud::fastest(14745600), 230400u);
+    EXPECT_EQ(baud::fastest(1000), 0u);
+}
+
+TEST(BaudTest, NearestRateToleratesMeasurementJitter) {
+    // The polling loop sees every edge up to about 8 cycles late; the shortest of many pulses
+    // is then up to 8 cycles short, and rarely much longer than the bit
+    for (uint32_t rate : baud::RATES) {
+        if (!baud::solve(F_16MHZ, rate).valid) continue;
+        const int32_t cycles = static_cast<int32_t>(F_16MHZ / rate);
+        for (int32_t jitter = -8; jitter <= 4; jitter++) {
+            const baud::setting s = baud::nearest(F_16MHZ, static_cast<uint32_t>(cycles + jitter));
+            ASSERT_TRUE(s.valid);
+            EXPECT_EQ(s.rate, rate) << cycles + jitter;
+        }
+    }
+    EXPECT_FALSE(baud::nearest(F_16MHZ, 0).valid);
+    EXPECT_EQ(baud::nearest(F_16MHZ, 60000).rate, 2400u);
+}
+
+TEST(BaudTest, BitTimeNeedsConfirmation) {
+    // 9600 baud: pulses of 1 to 4 bits of 1667 cycles, measured up to 8 cycles short
+    const uint16_t bit = 1667;
+    std::vector<uint16_t> widths;
+    for (uint16_t i = 0; i < 40; i++) widths.push_back(static_cast<uint16_t>(bit * (1 + i % 4) - i % 9));
+
+    // A noise spike does not pass for a bit, nor do three of them
+    for (uint16_t spike : {3, 5, 40}) widths.push_back(spike);
+    const uint16_t cycles = baud::bit_cycles(widths.data(), static_cast<uint8_t>(widths.size()));
+    EXPECT_NEAR(cycles, bit, baud::JITTER_CYCLES);
+    EXPECT_EQ(baud::nearest(F_16MHZ, cycles).rate, 9600u);
+
+    // Once CONFIRM spikes agree they are what the line carries
+    widths.push_back(4);
+    widths.push_back(6);
+    EXPECT_LT(baud::bit_cycles(widths.data(), static_cast<uint8_t>(widths.size())), 10);
+
+    // Too few pulses of any width, and pulses cut off by idle time (0)
+    const uint16_t few[] = {bit, 2 * bit, 3 * bit, bit, 0, 0, 0, 0, bit};
+    EXPECT_EQ(baud::bit_cycles(few, sizeof(few) / sizeof(few[0])), 0);
+}
@@ -0,0 +1,186 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "bus.h"
+
+namespace {
+
+// Run the scanner for a number of ticks and feed every tick to the decoder,
+// like the emulator driving the pins of the transmitter
+template <size_t N, int D>
+uint16_t run(bus::scanner<N, D>& scanner, bus::decoder<N, D>& decoder, uint32_t ticks) {
+    uint8_t portd = 0;
+    uint8_t portc = bus::IDLE;
+    uint16_t frames = 0;
+    for (uint32_t i = 0; i < ticks; i++) {
+        scanner.tick(portd, portc);
+        if (decoder.sample(portd, portc)) frames++;
+    }
+    return frames;
+}
+
+}  // namespace
+
+TEST(BusTest, EncodeDecodeRoundTrip) {
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int64_t> dist(-9999999, 9999999);
+    for (int i = 0; i < 10000; i++) {
+        int64_t in[5], out[5];
+        for (auto& v : in) v = dist(rng);
+        bus::frame<5, 7> frame;
+        bus::encode(in, frame);
+        ASSERT_TRUE(bus::decode(frame, out));
+        for (int j = 0; j < 5; j++) ASSERT_EQ(in[j], out[j]);
+    }
+}
+
+TEST(BusTest, EncodesSignAndDigits) {
+    int64_t in[2] = {-1204, 56};
+    bus::frame<2, 4> frame;
+    bus::encode(in, frame);
+    const uint8_t expected[2][5] = {{bus::CODE_MINUS, 1, 2, 0, 4}, {bus::CODE_BLANK, 0, 0, 5, 6}};
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 5; j++) EXPECT_EQ(frame.code[i][j], expected[i][j]);
+    }
+}
+
+TEST(BusTest, DecodeRejectsInvalidCodes) {
+    int64_t in[1] = {123456}, out[1];
+    bus::frame<1, 6> frame;
+    bus::encode(in, frame);
+    frame.code[0][3] = 0x0C;
+    EXPECT_FALSE(bus::decode(frame, out));
+    bus::encode(in, frame);
+    frame.code[0][0] = 5;
+    EXPECT_FALSE(bus::decode(frame, out));
+}
+
+TEST(BusTest, ScannerTiming) {
+    // Setup, strobe and hold phases for every slot, then an idle gap
+    bus::scanner<1, 2> scanner;
+    bus::frame<1, 2> frame = {{{bus::CODE_BLANK, 4, 2}}, 0};
+    scanner.load(frame);
+    scanner.status = bus::ER_MASK;
+
+    uint8_t portd = 0, portc = bus::IDLE;
+    scanner.tick(portd, portc);  // Gap ends, setup of slot 0
+    for (uint8_t position = 0; position < 3; position++) {
+        EXPECT_EQ(portc, bus::IDLE);
+        EXPECT_EQ(bus::code_of(portd), frame.code[0][position]);
+        EXPECT_EQ(bus::status_of(portd), bus::ER_MASK);
+        scanner.tick(portd, portc);
+        EXPECT_EQ(portc, bus::address(0, position));
+        scanner.tick(portd, portc);
+        EXPECT_EQ(portc, bus::IDLE);
+        EXPECT_EQ(bus::code_of(portd), frame.code[0][position]);
+        EXPECT_EQ(scanner.tick(portd, portc), position == 2);
+    }
+    for (uint8_t i = 0; i < bus::scanner<1, 2>::GAP_TICKS; i++) {
+        EXPECT_EQ(portc, bus::IDLE);
+        scanner.tick(portd, portc);
+    }
+    EXPECT_EQ(bus::code_of(portd), frame.code[0][0]);
+}
+
+TEST(BusTest, DecoderFollowsScanner) {
+    bus::scanner<4, 6> scanner;
+    bus::decoder<4, 6> decoder;
+    int64_t in[4] = {123456, -654321, 0, -1};
+    bus::frame<4, 6> frame;
+    bus::encode(in, frame);
+    scanner.load(frame);
+    scanner.status = bus::A7_MASK;
+
+    constexpr uint16_t frame_ticks = bus::scanner<4, 6>::TICKS_PER_FRAME;
+    EXPECT_EQ(run(scanner, decoder, frame_ticks * 10), 10);
+    EXPECT_EQ(decoder.glitches(), 0);
+
+    int64_t out[4];
+    ASSERT_TRUE(bus::decode(decoder.last(), out));
+    for (int i = 0; i < 4; i++) EXPECT_EQ(out[i], in[i]);
+    EXPECT_EQ(decoder.last().status, bus::A7_MASK);
+}
+
+TEST(BusTest, DecoderSynchronisesMidFrame) {
+    // Start listening in the middle of a frame: that frame is skipped silently
+    bus::scanner<2, 3> scanner;
+    bus::decoder<2, 3> decoder;
+    int64_t in[2] = {12, -34};
+    bus::frame<2, 3> frame;
+    bus::encode(in, frame);
+    scanner.load(frame);
+
+    uint8_t portd = 0, portc = bus::IDLE;
+    for (int i = 0; i < bus::scanner<2, 3>::TICKS_PER_FRAME + 10; i++) scanner.tick(portd, portc);
+    uint16_t frames = 0;
+    for (int i = 0; i < bus::scanner<2, 3>::TICKS_PER_FRAME * 3; i++) {
+        scanner.tick(portd, portc);
+        if (decoder.sample(portd, portc)) frames++;
+    }
+    EXPECT_EQ(frames, 2);
+    EXPECT_EQ(decoder.glitches(), 0);
+}
+
+TEST(BusTest, GlitchesAreRejected) {
+    bus::scanner<4, 6> scanner;
+    bus::decoder<4, 6> decoder;
+    int64_t in[4] = {111111, 222222, 333333, 444444};
+    bus::frame<4, 6> frame;
+    bus::encode(in, frame);
+    scanner.load(frame);
+
+    // One glitch in every frame: no frame survives, but nothing wrong is decoded either
+    scanner.glitch_interval = bus::frame<4, 6>::SLOTS;
+    constexpr uint16_t frame_ticks = bus::scanner<4, 6>::TICKS_PER_FRAME;
+    EXPECT_EQ(run(scanner, decoder, frame_ticks * 10), 0);
+    EXPECT_GE(decoder.glitches(), 9);
+
+    // Glitches off: frames come through again
+    scanner.glitch_interval = 0;
+    EXPECT_GE(run(scanner, decoder, frame_ticks * 10), 9);
+    int64_t out[4];
+    ASSERT_TRUE(bus::decode(decoder.last(), out));
+    for (int i = 0; i < 4; i++) EXPECT_EQ(out[i], in[i]);
+}
+
+TEST(BusTest, UnstableCodeIsRejected) {
+    bus::decoder<1, 1> decoder;
+    const uint8_t digit_7 = bus::portd(7, 0), digit_8 = bus::portd(8, 0);
+    const uint8_t blank = bus::portd(bus::CODE_BLANK, 0);
+
+    // Clean frame
+    decoder.sample(blank, bus::IDLE);
+    decoder.sample(blank, bus::address(0, 0));
+    decoder.sample(blank, bus::IDLE);
+    decoder.sample(digit_7, bus::IDLE);
+    decoder.sample(digit_7, bus::address(0, 1));
+    EXPECT_TRUE(decoder.sample(digit_7, bus::IDLE));
+    EXPECT_EQ(decoder.last().code[0][1], 7);
+
+    // Code changes during the strobe
+    decoder.sample(blank, bus::IDLE);
+    decoder.sample(blank, bus::address(0, 0));
+    decoder.sample(blank, bus::IDLE);
+    decoder.sample(digit_7, bus::address(0, 1));
+    decoder.sample(digit_8, bus::address(0, 1));
+    EXPECT_FALSE(decoder.sample(digit_8, bus::IDLE));
+    EXPECT_EQ(decoder.glitches(), 1);
+    EXPECT_EQ(decoder.last().code[0][1], 7);
+}
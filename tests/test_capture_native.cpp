@@ -0,0 +1,180 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "bus.h"
+#include "capture.h"
+
+namespace {
+
+// Record the scanner output as a VCD, one tick every tick_ns
+template <size_t N, int D>
+std::string record(bus::scanner<N, D>& scanner, uint32_t ticks, int64_t tick_ns) {
+    FILE* file = tmpfile();
+    capture::vcd_writer writer(file);
+    uint8_t portd = 0, portc = bus::IDLE;
+    for (uint32_t i = 0; i < ticks; i++) {
+        scanner.tick(portd, portc);
+        writer.write({static_cast<int64_t>(i) * tick_ns * 1000, portd, portc});
+    }
+    std::string text(static_cast<size_t>(ftell(file)), '\0');
+    rewind(file);
+    EXPECT_EQ(fread(&text[0], 1, text.size(), file), text.size());
+    fclose(file);
+    return text;
+}
+
+std::vector<capture::event> parse_vcd(const std::string& text, const capture::channel_map& map = {}) {
+    std::vector<capture::event> events;
+    std::string error;
+    EXPECT_TRUE(capture::parse_vcd(
+        text.data(), text.data() + text.size(), map, [&](const capture::event& e) { events.push_back(e); }, error))
+        << error;
+    return events;
+}
+
+}  // namespace
+
+TEST(CaptureTest, VcdRoundTrip) {
+    bus::scanner<3, 5> scanner;
+    int64_t in[3] = {12345, -678, 0};
+    bus::frame<3, 5> frame;
+    bus::encode(in, frame);
+    scanner.load(frame);
+    scanner.status = bus::ER_MASK;
+
+    auto events = parse_vcd(record(scanner, bus::scanner<3, 5>::TICKS_PER_FRAME * 5, 160));
+    bus::decoder<3, 5> decoder;
+    int frames = 0;
+    for (auto& e : events) {
+        if (decoder.sample(e.pind, e.pinc)) frames++;
+    }
+    EXPECT_GE(frames, 4);
+    EXPECT_EQ(decoder.glitches(), 0);
+
+    int64_t out[3];
+    ASSERT_TRUE(bus::decode(decoder.last(), out));
+    for (int i = 0; i < 3; i++) EXPECT_EQ(out[i], in[i]);
+    EXPECT_EQ(decoder.last().status, bus::ER_MASK);
+}
+
+TEST(CaptureTest, TimingStatistics) {
+    bus::scanner<2, 3> scanner;
+    int64_t in[2] = {123, -456};
+    bus::frame<2, 3> frame;
+    bus::encode(in, frame);
+    scanner.load(frame);
+
+    // 160 us ticks: 480 us slots, one tick each for setup, strobe and hold
+    capture::timing timing;
+    for (auto& e : parse_vcd(record(scanner, bus::scanner<2, 3>::TICKS_PER_FRAME * 3, 160000))) timing.add(e);
+
+    const int64_t tick = 160000000;  // ps
+    EXPECT_EQ(timing.width.min, tick);
+    EXPECT_EQ(timing.width.max, tick);
+    EXPECT_EQ(timing.period.min, 3 * tick);
+    EXPECT_EQ(timing.period.max, (3 + bus::scanner<2, 3>::GAP_TICKS) * tick);
+    EXPECT_EQ(timing.setup.max, tick);
+    EXPECT_GE(timing.hold.min, tick);
+}
+
+TEST(CaptureTest, VcdTimescaleAndIdentifiers) {
+    // Multi-character identifiers, unknown channels, aliases, x values and vectors
+    const std::string text =
+        "$date today $end\n"
+        "$timescale 10 ns $end\n"
+        "$scope module la $end\n"
+        "$var wire 1 !! D0 $end\n"
+        "$var wire 1 \"# W2 $end\n"
+        "$var wire 1 $ B0 $end\n"
+        "$var wire 8 % bus $end\n"
+        "$upscope $end\n"
+        "$enddefinitions $end\n"
+        "#0\n"
+        "$dumpvars\n"
+        "x!!\n"
+        "0\"#\n"
+        "1$\n"
+        "b10101010 %\n"
+        "$end\n"
+        "#5\n"
+        "1!!\n"
+        "b1 \"#\n"
+        "#7\n"
+        "0$\n";
+    capture::channel_map map;
+    ASSERT_TRUE(map.add("D0=W1"));
+    auto events = parse_vcd(text, map);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].time_ps, 50000);
+    EXPECT_EQ(bus::code_of(events[0].pind), 3);
+    EXPECT_EQ(events[1].time_ps, 70000);
+    EXPECT_EQ(bus::address_of(events[1].pinc), bus::IDLE & ~1);
+}
+
+TEST(CaptureTest, CsvWithTimeColumn) {
+    const std::string text =
+        "; sigrok export\n"
+        "Time [s],W1,W2,W4,W8,B0,B1,B2,B3,B4,B5\n"
+        "0.000000,0,0,0,0,1,1,1,1,1,1\n"
+        "0.000010,1,0,1,0,1,1,1,1,1,1\n"
+        "0.000020,1,0,1,0,1,1,1,1,1,1\n"
+        "0.000030,1,0,1,0,0,1,1,1,1,1\n";
+    std::vector<capture::event> events;
+    std::string error;
+    ASSERT_TRUE(capture::parse_csv(
+        text.data(), text.data() + text.size(), {}, 0, [&](const capture::event& e) { events.push_back(e); }, error))
+        << error;
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].time_ps, 10000000);
+    EXPECT_EQ(bus::code_of(events[0].pind), 5);
+    EXPECT_EQ(events[1].time_ps, 30000000);
+    EXPECT_EQ(bus::address_of(events[1].pinc), 0x3E);
+}
+
+TEST(CaptureTest, CsvWithSampleRate) {
+    // No time column: rows are one sample period apart
+    const std::string text =
+        "D0,D1\r\n"
+        "0,1\r\n"
+        "1,1\r\n"
+        "1,0\r\n";
+    capture::channel_map map;
+    ASSERT_TRUE(map.add("D0=W8"));
+    ASSERT_TRUE(map.add("D1=B0"));
+    std::vector<capture::event> events;
+    std::string error;
+    auto sink = [&](const capture::event& e) { events.push_back(e); };
+
+    EXPECT_FALSE(capture::parse_csv(text.data(), text.data() + text.size(), map, 0, sink, error));
+    ASSERT_TRUE(capture::parse_csv(text.data(), text.data() + text.size(), map, 1e-6, sink, error)) << error;
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].time_ps, 1000000);
+    EXPECT_EQ(bus::code_of(events[0].pind), 8);
+    EXPECT_EQ(events[1].time_ps, 2000000);
+    EXPECT_EQ(bus::address_of(events[1].pinc), 0x3E);
+}
+
+TEST(CaptureTest, MissingLinesAreReported) {
+    const std::string text = "$var wire 1 ! clk $end\n$enddefinitions $end\n#0\n1!\n";
+    std::string error;
+    EXPECT_FALSE(capture::parse_vcd(text.data(), text.data() + text.size(), {}, [](const capture::event&) {}, error));
+    EXPECT_FALSE(error.empty());
+}
@@ -0,0 +1,176 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fast_parse.h"
+#include "format.h"
+#include "parse.h"
+
+namespace {
+
+// Instruction sets this host can run
+std::vector<fast_parse::isa> isas() {
+    std::vector<fast_parse::isa> all = {fast_parse::isa::SCALAR};
+    if (fast_parse::detect() >= fast_parse::isa::SSE2) all.push_back(fast_parse::isa::SSE2);
+    if (fast_parse::detect() >= fast_parse::isa::AVX2) all.push_back(fast_parse::isa::AVX2);
+    return all;
+}
+
+template <int D>
+int64_t random_value(std::mt19937& rng) {
+    int64_t max = 1;
+    for (int i = 0; i < D; i++) max *= 10;
+    std::uniform_int_distribution<int64_t> dist(-(max - 1), max - 1);
+    return dist(rng);
+}
+
+template <size_t N, int D, int P>
+std::string random_line(std::mt19937& rng) {
+    int64_t in[N];
+    for (auto& v : in) v = random_value<D>(rng);
+    char line[N * 10 + 1];
+    return format<N, D, P>(in, line);
+}
+
+// Every instruction set gives the reference result on a line, in a window padded with a filler
+template <size_t N, int D, int P>
+void expect_agreement(const std::string& text, char filler = '\0') {
+    using parser_t = fast_parse::parser<N, D, P>;
+    char window[fast_parse::WINDOW];
+    memset(window, filler, sizeof(window));
+    memcpy(window, text.data(), std::min(text.size(), sizeof(window)));
+
+    int32_t expected[N] = {}, axis[N] = {};
+    const bool accepted = parser_t::line_scalar(window, expected);
+    for (fast_parse::isa which : isas()) {
+        ASSERT_EQ(parser_t(which).line(window, axis), accepted) << fast_parse::name(which) << " '" << text << "'";
+        if (!accepted) continue;
+        for (size_t i = 0; i < N; i++) ASSERT_EQ(axis[i], expected[i]) << fast_parse::name(which) << " " << text;
+    }
+
+    // The strict layout is a subset of what parse() takes, with the same values
+    if (accepted) {
+        int32_t loose[N];
+        ASSERT_TRUE((parse<N, D, P>(text.c_str(), loose))) << text;
+        for (size_t i = 0; i < N; i++) ASSERT_EQ(loose[i], expected[i]) << text;
+    }
+}
+
+template <size_t N, int D, int P>
+void round_trip(uint32_t seed) {
+    std::mt19937 rng(seed);
+    for (int i = 0; i < 2000; i++) {
+        int64_t in[N];
+        for (auto& v : in) v = random_value<D>(rng);
+        char line[N * 10 + 1];
+        format<N, D, P>(in, line);
+        ASSERT_EQ(strlen(line), (fast_parse::parser<N, D, P>::LINE));
+        for (fast_parse::isa which : isas()) {
+            int32_t out[N];
+            char window[fast_parse::WINDOW] = {};
+            memcpy(window, line, strlen(line));
+            ASSERT_TRUE((fast_parse::parser<N, D, P>(which).line(window, out))) << fast_parse::name(which) << line;
+            for (size_t j = 0; j < N; j++) ASSERT_EQ(out[j], in[j]) << fast_parse::name(which) << line;
+        }
+    }
+}
+
+// Damage random lines a byte or two at a time with the characters that matter most
+template <size_t N, int D, int P>
+void malformed(uint32_t seed) {
+    static const char NASTY[] = " -.:\n0189/#x\0\xb0";
+    std::mt19937 rng(seed);
+    for (int i = 0; i < 5000; i++) {
+        std::string line = random_line<N, D, P>(rng);
+        for (uint32_t n = 1 + rng() % 2; n > 0; n--) line[rng() % line.size()] = NASTY[rng() % (sizeof(NASTY) - 1)];
+        if (rng() % 8 == 0) line.erase(rng() % line.size(), 1);
+        expect_agreement<N, D, P>(line, static_cast<char>(rng() % 2 ? ' ' : '0'));
+    }
+}
+
+}  // namespace
+
+TEST(FastParseTest, RoundTripsFormat) {
+    round_trip<4, 6, 4>(1);
+    round_trip<1, 1, 1>(2);
+    round_trip<5, 7, 4>(3);
+    round_trip<3, 4, 4>(4);  // No dot: 9 byte fields
+    round_trip<2, 5, 0>(5);  // Dot first
+    round_trip<5, 7, 7>(6);
+    round_trip<3, 7, 0>(7);
+    round_trip<5, 1, 0>(8);
+}
+
+TEST(FastParseTest, MalformedLinesAgreeWithTheReference) {
+    malformed<4, 6, 4>(11);
+    malformed<3, 4, 4>(12);
+    malformed<2, 5, 0>(13);
+    malformed<5, 7, 3>(14);
+    malformed<1, 7, 6>(15);
+}
+
+TEST(FastParseTest, EdgesOfTheLayout) {
+    expect_agreement<2, 6, 4>("  1234.56: -0000.01\n");
+    expect_agreement<2, 6, 4>("  1234.56: -0000.01");       // No newline
+    expect_agreement<2, 6, 4>("  1234.56:  -000.01\n");     // Sign in the wrong place
+    expect_agreement<2, 6, 4>("  1234.56:- 0000.01\n");
+    expect_agreement<2, 6, 4>("  1234.56:  0000.01:\n");    // Extra field
+    expect_agreement<2, 6, 4>("  1234,56:  0000.01\n");
+    expect_agreement<2, 6, 4>("  12340.56:  000.01\n");
+
+    int32_t axis[2];
+    char window[fast_parse::WINDOW] = "  1234.56: -0000.01\n";
+    for (fast_parse::isa which : isas()) {
+        ASSERT_TRUE((fast_parse::parser<2, 6, 4>(which).line(window, axis)));
+        EXPECT_EQ(axis[0], 123456);
+        EXPECT_EQ(axis[1], -1);
+    }
+}
+
+TEST(FastParseTest, BufferSkipsOtherLines) {
+    // Data lines between time stamps, a status line, a damaged line and a line cut off at the end
+    std::mt19937 rng(21);
+    std::string buffer;
+    std::vector<std::string> lines;
+    for (int i = 0; i < 300; i++) {
+        buffer += "#t0012abcd\n";
+        lines.push_back(random_line<4, 6, 4>(rng));
+        buffer += lines.back();
+        if (i == 100) buffer += "!00012abc\n";
+        if (i == 200) buffer += "  1234.56:  0000.0x:  0000.00:  0000.00\n";
+    }
+    buffer += lines.back().substr(0, 20);
+
+    for (fast_parse::isa which : isas()) {
+        std::vector<std::string> out;
+        fast_parse::stats s = fast_parse::parser<4, 6, 4>(which).parse(
+            buffer.data(), buffer.data() + buffer.size(), [&](const int32_t (&axis)[4]) {
+                int64_t values[4] = {axis[0], axis[1], axis[2], axis[3]};
+                char line[41];
+                out.push_back(format<4, 6, 4>(values, line));
+            });
+        EXPECT_EQ(s.frames, 300u) << fast_parse::name(which);
+        EXPECT_EQ(s.other, 303u) << fast_parse::name(which);
+        EXPECT_EQ(out, lines) << fast_parse::name(which);
+    }
+}
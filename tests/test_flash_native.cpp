@@ -0,0 +1,77 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "flash.h"
+#include "segments.h"
+
+namespace {
+
+struct pair_t {
+    uint16_t a;
+    uint32_t b;
+};
+
+const pair_t PAIRS[] PROGMEM = {{1, 100000}, {2, 200000}};
+const char TEXT[] PROGMEM = "8.:12";
+
+}  // namespace
+
+TEST(FlashTest, ReadsObjects) {
+    pair_t p = flash::read(&PAIRS[1]);
+    EXPECT_EQ(p.a, 2);
+    EXPECT_EQ(p.b, 200000u);
+}
+
+TEST(FlashTest, PointerIteratesString) {
+    std::string out;
+    for (flash::string s(TEXT); *s; s++) out += *s;
+    EXPECT_EQ(out, "8.:12");
+
+    flash::string s = FLASH_STRING("abc");
+    EXPECT_EQ(s[2], 'c');
+    EXPECT_EQ(*(s + 1), 'b');
+    EXPECT_EQ(*++s, 'b');
+}
+
+TEST(FlashTest, SegmentGlyphs) {
+    // Same patterns as the character switch the table replaced
+    const char digits[] = "0123456789";
+    const uint8_t patterns[] = {0x7E, 0x30, 0x6D, 0x79, 0x33, 0x5B, 0x5F, 0x70, 0x7F, 0x7B};
+    for (int i = 0; i < 10; i++) EXPECT_EQ(segment_from_ascii(digits[i]), patterns[i]);
+
+    const char letters[] = "ABCDEFRO";
+    const uint8_t letter_patterns[] = {0x77, 0x1F, 0x4E, 0x3D, 0x4F, 0x47, 0x05, 0x1D};
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(segment_from_ascii(letters[i]), letter_patterns[i]);
+        EXPECT_EQ(segment_from_ascii(static_cast<char>(letters[i] - 'A' + 'a')), letter_patterns[i]);
+    }
+
+    EXPECT_EQ(segment_from_ascii('-'), 0x01);
+    EXPECT_EQ(segment_from_ascii('.'), segments::DOT);
+    EXPECT_EQ(segment_from_ascii(','), segments::DOT);
+
+    // Everything else is blank, including control and non-ASCII characters
+    int shown = 0;
+    for (int c = -128; c < 128; c++) {
+        if (segment_from_ascii(static_cast<char>(c)) != 0) shown++;
+    }
+    EXPECT_EQ(shown, 10 + 16 + 3);
+}
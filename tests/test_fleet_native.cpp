@@ -0,0 +1,214 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "fleet.h"
+#include "parse.h"
+
+namespace {
+
+// Lines of a number of frames, split at the newlines
+std::vector<std::string> lines(fleet::machine& m, int frames, uint32_t ticks = 0) {
+    std::vector<std::string> out;
+    char buffer[fleet::MAX_FRAME_SIZE];
+    for (int i = 0; i < frames; i++) {
+        const std::string text(buffer, m.frame(ticks + static_cast<uint32_t>(i), buffer));
+        for (size_t begin = 0, end; (end = text.find('\n', begin)) != std::string::npos; begin = end + 1) {
+            out.push_back(text.substr(begin, end - begin + 1));
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST(FleetTest, GeneratorFollowsTheEmulator) {
+    EXPECT_EQ(pattern::following(pattern::algorithm_t::RANDOM), pattern::algorithm_t::INCREMENTING);
+    EXPECT_EQ(pattern::following(pattern::algorithm_t::DECREMENTING), pattern::algorithm_t::RANDOM);
+    EXPECT_EQ(pattern::max_abs(6), 999999);
+
+    // Random values are held for a second of frames
+    pattern::generator<2, 3> g;
+    uint32_t seed = 1;
+    auto random = [&] { return seed = seed * 1103515245 + 12345; };
+    int64_t current[2] = {}, next[2];
+    g.next(pattern::algorithm_t::RANDOM, current, next, 3, random);
+    EXPECT_LT(std::abs(next[0]), 999);
+    EXPECT_NE(next[0], 0);
+    int64_t held[2] = {next[0], next[1]};
+    for (int i = 0; i < 2; i++) {
+        g.next(pattern::algorithm_t::RANDOM, held, next, 3, random);
+        EXPECT_EQ(next[0], held[0]);
+    }
+    g.next(pattern::algorithm_t::RANDOM, held, next, 3, random);
+    EXPECT_NE(next[0], held[0]);
+
+    // Counting stops at the largest value shown
+    int64_t edge[2] = {998, -998};
+    g.next(pattern::algorithm_t::INCREMENTING, edge, next, 3, random);
+    EXPECT_EQ(next[0], 999);
+    g.next(pattern::algorithm_t::INCREMENTING, next, edge, 3, random);
+    EXPECT_EQ(edge[0], 999);
+    int64_t low[2] = {0, -998};
+    g.next(pattern::algorithm_t::DECREMENTING, low, next, 3, random);
+    EXPECT_EQ(next[1], -999);
+    g.next(pattern::algorithm_t::DECREMENTING, next, low, 3, random);
+    EXPECT_EQ(low[1], -999);
+}
+
+TEST(FleetTest, MachinesSendTheEmulatorLines) {
+    // Every layout of the firmware, and nothing else
+    int layouts = 0;
+    for (uint16_t code = 0; code < 1000; code++) {
+        const bool made = fleet::make(code, 50, 1) != nullptr;
+        EXPECT_EQ(made, fleet::valid(code)) << code;
+        layouts += made;
+    }
+    EXPECT_EQ(layouts, 5 * 35);
+    EXPECT_EQ(fleet::make(464, 0, 1), nullptr);
+
+    // Sync line once a second, a time stamp before every data line
+    auto m = fleet::make(364, 10, 7);
+    const std::vector<std::string> out = lines(*m, 30, 0x1000);
+    ASSERT_EQ(out.size(), 63u);
+    for (size_t i = 0, frame = 0; i < out.size(); frame++) {
+        char tag = 0;
+        uint32_t value = 0;
+        if (frame % 10 == 0) {
+            ASSERT_TRUE(stamp::parse(out[i].substr(0, 10).c_str(), tag, value));
+            EXPECT_EQ(tag, stamp::SYNC);
+            i++;
+        }
+        ASSERT_TRUE(stamp::parse(out[i].substr(0, 10).c_str(), tag, value));
+        EXPECT_EQ(tag, stamp::TIME);
+        EXPECT_EQ(value, 0x1000 + frame);
+        int32_t axis[3];
+        ASSERT_EQ(out[i + 1].size(), 30u);
+        ASSERT_TRUE((parse<3, 6, 4>(out[i + 1].c_str(), axis))) << out[i + 1];
+        i += 2;
+    }
+
+    // Layouts without a dot have one character less per field
+    char buffer[fleet::MAX_FRAME_SIZE];
+    for (uint16_t code : {333, 577}) {
+        auto plain = fleet::make(code, 10, 3);
+        const size_t axes = code / 100;
+        for (uint32_t frame = 0; frame < 20; frame++) {
+            const std::string text(buffer, plain->frame(frame, buffer));
+            EXPECT_EQ(text.find('\0'), std::string::npos) << code;
+            EXPECT_EQ(text.size(), (frame % 10 == 0 ? 2 : 1) * stamp::LINE_SIZE + axes * 9) << code;
+            EXPECT_EQ(text.back(), '\n') << code;
+        }
+    }
+    int32_t plain_axis[3];
+    const std::vector<std::string> plain = lines(*fleet::make(333, 10, 3), 1);
+    ASSERT_EQ(plain.size(), 3u);
+    EXPECT_TRUE((parse<3, 3, 3>(plain[2].c_str(), plain_axis))) << plain[2];
+
+    // Counting up after the random pattern
+    const std::vector<std::string> up = lines(*m, 10 * pattern::CYCLE_SECONDS);
+    int32_t before[3], after[3];
+    ASSERT_TRUE((parse<3, 6, 4>(up[up.size() - 3].c_str(), before)));
+    ASSERT_TRUE((parse<3, 6, 4>(up.back().c_str(), after)));
+    for (int i = 0; i < 3; i++) EXPECT_EQ(after[i], std::min(before[i] + 1, 999999));
+}
+
+TEST(FleetTest, DeadlinesDoNotDrift) {
+    for (uint32_t rate : {1u, 3u, 7u, 50u, 333u, 2000u}) {
+        EXPECT_EQ(fleet::deadline_ns(rate, rate), 1000000000);
+        EXPECT_EQ(fleet::deadline_ns(rate * 3600ull, rate), 3600000000000);
+        for (uint64_t i = 1; i < 2 * rate; i++) {
+            const int64_t step = fleet::deadline_ns(i, rate) - fleet::deadline_ns(i - 1, rate);
+            ASSERT_LE(std::abs(step - 1000000000 / static_cast<int64_t>(rate)), 1) << rate << " " << i;
+        }
+    }
+}
+
+TEST(FleetTest, SchedulerServesEarliestDeadlineFirst) {
+    fleet::stream a, b;
+    a.rate = 50;
+    b.rate = 30;
+    b.start_ns = 1000;
+    fleet::scheduler s;
+    s.add(&a);
+    s.add(&b);
+    int64_t last = 0;
+    for (int i = 0; i < 160; i++) {
+        fleet::stream* top = s.top();
+        ASSERT_GE(top->due(), last);
+        last = top->due();
+        s.advance();
+    }
+    EXPECT_EQ(a.index, 100u);
+    EXPECT_EQ(b.index, 60u);
+    s.remove();
+    s.remove();
+    EXPECT_TRUE(s.empty());
+
+    fleet::jitter j;
+    for (int64_t late : {1000, 3000, 1000, 3000}) j.add(late);
+    EXPECT_EQ(j.count(), 4u);
+    EXPECT_DOUBLE_EQ(j.mean_us(), 2.0);
+    EXPECT_DOUBLE_EQ(j.rms_us(), 1.0);
+    EXPECT_DOUBLE_EQ(j.max_us(), 3.0);
+}
+
+TEST(FleetTest, PartialWritesAreFinished) {
+    // Output that takes up to `room` bytes per write
+    std::string out;
+    size_t room = 0;
+    auto write = [&](const char* data, size_t size) -> long {
+        const size_t n = std::min(size, room);
+        if (n == 0) return -1;
+        out.append(data, n);
+        room -= n;
+        return static_cast<long>(n);
+    };
+    fleet::stream s;
+    room = 100;
+    s.send("0123456789\n", 11, write);
+    EXPECT_EQ(s.bytes, 11u);
+
+    // Cut after 4 bytes: the rest goes ahead of the next frame
+    room = 4;
+    s.send("abcdefghij\n", 11, write);
+    EXPECT_EQ(s.partial, 1u);
+    EXPECT_EQ(s.dropped, 0u);
+
+    // Still no room for the rest: the next frame is dropped whole
+    room = 3;
+    s.send("ABCDEFGHIJ\n", 11, write);
+    EXPECT_EQ(s.dropped, 1u);
+
+    room = 100;
+    s.send("klmnopqrst\n", 11, write);
+    EXPECT_EQ(out, "0123456789\nabcdefghij\nklmnopqrst\n");
+    EXPECT_EQ(s.bytes, out.size());
+
+    // Nothing taken: dropped, nothing left over
+    room = 0;
+    s.send("uvwxyz\n", 7, write);
+    room = 100;
+    s.send("end\n", 4, write);
+    EXPECT_EQ(s.dropped, 2u);
+    EXPECT_EQ(s.partial, 1u);
+    EXPECT_EQ(out.substr(out.size() - 4), "end\n");
+}
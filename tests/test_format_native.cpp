@@ -16,6 +16,8 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+
 #include "format.h"
 
 TEST(FormatTest, FormatsFourAxisValues) {
@@ -120,4 +122,46 @@ TEST(FormatTest, SpecialCase1) {
     char* result = format(arr);
     ASSERT_NE(result, nullptr);
     EXPECT_STREQ(result, "  1002.46:  9510.15: -3978.91: -9086.26\n");
-}
\ No newline at end of file
+}
+
+namespace {
+
+// The 32-bit format writes the same line as the 64-bit one
+template <size_t N, int D, int P>
+void same_as_int64(uint32_t seed) {
+    uint32_t state = seed;
+    const int32_t max = static_cast<int32_t>(std::pow(10, D)) - 1;
+    for (int i = 0; i < 2000; i++) {
+        int32_t narrow[N];
+        int64_t wide[N];
+        for (size_t j = 0; j < N; j++) {
+            state = state * 1103515245 + 12345;
+            const int32_t edge[] = {0, max, -max, 1, -1};
+            narrow[j] = i < 5 ? edge[i] : static_cast<int32_t>(state % (2u * max + 1)) - max;
+            wide[j] = narrow[j];
+        }
+        char a[N * 10 + 1], b[N * 10 + 1];
+        ASSERT_STREQ((format<N, D, P>(narrow, a)), (format<N, D, P>(wide, b)));
+    }
+}
+
+}  // namespace
+
+TEST(FormatTest, Int32FormatMatchesInt64) {
+    same_as_int64<4, 6, 4>(1);
+    same_as_int64<4, 6, 3>(2);  // Inch layout
+    same_as_int64<5, 7, 7>(3);  // No dot
+    same_as_int64<2, 7, 0>(4);  // Dot first
+    same_as_int64<1, 1, 1>(5);
+    same_as_int64<3, 3, 1>(6);
+    same_as_int64<5, 7, 4>(7);
+}
+
+TEST(FormatTest, Int32FormatClampsToTheLayout) {
+    const int32_t axis[4] = {1000000, -1000000, INT32_MAX, INT32_MIN};
+    char buffer[4 * 10 + 1];
+    EXPECT_STREQ((format<4, 6, 4>(axis, buffer)), "  9999.99: -9999.99:  9999.99: -9999.99\n");
+    const int32_t one[1] = {10};
+    char small[1 * 10 + 1];
+    EXPECT_STREQ((format<1, 1, 1>(one, small)), "       9\n");
+}
@@ -0,0 +1,163 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "format.h"
+
+// Every value of every digit count and dot position config.h allows, through every formatting
+// engine, compared with a reference formatter. The sweep is split into chunks that the worker
+// threads take from a shared counter, so it scales with the number of cores. Faster engines are
+// checked by adding them to check_chunk().
+
+namespace {
+
+constexpr int MAX_DIGITS = 7;
+constexpr int64_t CHUNK = 1 << 16;
+
+// Straightforward formatter for one axis with its separator
+// Field: 8 - D characters of padding ending with the sign, P integer digits, '.', D - P fractional digits
+int reference(int64_t value, int digits, int dot, char* out) {
+    char* p = out;
+    uint64_t magnitude = static_cast<uint64_t>(value < 0 ? -value : value);
+    for (int i = 0; i < 8 - digits; i++) *p++ = ' ';
+    if (value < 0) p[-1] = '-';
+    char text[MAX_DIGITS];
+    for (int i = digits - 1; i >= 0; i--) {
+        text[i] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    }
+    for (int i = 0; i < digits; i++) {
+        if (i == dot) *p++ = '.';
+        *p++ = text[i];
+    }
+    *p++ = '\n';
+    *p = '\0';
+    return static_cast<int>(p - out);
+}
+
+// One range of values of one configuration
+// Returns the number of mismatches, the first one is described in first
+using check_t = uint64_t (*)(int64_t begin, int64_t end, std::string& first);
+
+// Compare one engine's output with the reference, describe the first mismatch
+bool matches(const char* engine, int digits, int dot, int64_t value, const char* actual, const char* expected,
+             uint64_t& mismatches, std::string& first) {
+    // Canary behind the documented buffer size catches overruns
+    if (strcmp(actual, expected) == 0 && actual[11] == '\x7f') return true;
+    if (mismatches++ == 0) {
+        first = std::string(engine) + "<1, " + std::to_string(digits) + ", " + std::to_string(dot) + ">(" +
+                std::to_string(value) + ") = \"" + actual + "\", expected \"" + expected + "\"";
+    }
+    return false;
+}
+
+template <int D, int P>
+uint64_t check_chunk(int64_t begin, int64_t end, std::string& first) {
+    uint64_t mismatches = 0;
+    for (int64_t value = begin; value < end; value++) {
+        char expected[16], actual[16];
+        reference(value, D, P, expected);
+
+        // sprintf_P engine on 64-bit values
+        actual[11] = '\x7f';
+        const int64_t wide[1] = {value};
+        format<1, D, P>(wide, actual);
+        matches("format<int64_t>", D, P, value, actual, expected, mismatches, first);
+
+        // Subtraction engine on 32-bit values (receiver)
+        actual[11] = '\x7f';
+        const int32_t narrow[1] = {static_cast<int32_t>(value)};
+        format<1, D, P>(narrow, actual);
+        matches("format<int32_t>", D, P, value, actual, expected, mismatches, first);
+    }
+    return mismatches;
+}
+
+struct config_t {
+    int digits;
+    int dot;
+    check_t check;
+};
+
+template <int D, int... P>
+void add_configs(std::vector<config_t>& configs, std::integer_sequence<int, P...>) {
+    (configs.push_back({D, P, &check_chunk<D, P>}), ...);
+}
+
+template <int... D>
+std::vector<config_t> all_configs(std::integer_sequence<int, D...>) {
+    std::vector<config_t> configs;
+    (add_configs<D + 1>(configs, std::make_integer_sequence<int, D + 2>{}), ...);
+    return configs;
+}
+
+struct job_t {
+    const config_t* config;
+    int64_t begin;
+    int64_t end;
+};
+
+}  // namespace
+
+TEST(FormatSweepTest, AllConfigurationsAllValues) {
+    // Configurations allowed by config.h: 1 <= D <= 7, 0 <= P <= D
+    const std::vector<config_t> configs = all_configs(std::make_integer_sequence<int, MAX_DIGITS>{});
+    ASSERT_EQ(configs.size(), 35u);
+
+    std::vector<job_t> jobs;
+    for (const config_t& config : configs) {
+        int64_t max = 1;
+        for (int i = 0; i < config.digits; i++) max *= 10;
+        for (int64_t begin = -(max - 1); begin < max; begin += CHUNK) {
+            jobs.push_back({&config, begin, std::min(begin + CHUNK, max)});
+        }
+    }
+    uint64_t total = 0;
+    for (const job_t& job : jobs) total += static_cast<uint64_t>(job.end - job.begin);
+
+    std::atomic<size_t> next{0};
+    std::atomic<uint64_t> checked{0};
+    std::atomic<uint64_t> mismatches{0};
+    std::vector<std::string> first(jobs.size());
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < jobs.size(); i = next++) {
+            const job_t& job = jobs[i];
+            mismatches += job.config->check(job.begin, job.end, first[i]);
+            checked += static_cast<uint64_t>(job.end - job.begin);
+        }
+    };
+
+    unsigned count = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < count; i++) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(checked.load(), total);
+    EXPECT_EQ(mismatches.load(), 0u);
+    for (const std::string& message : first) {
+        if (!message.empty()) {
+            ADD_FAILURE() << message;
+            break;
+        }
+    }
+}
@@ -0,0 +1,258 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "irq.h"
+
+// The simulated ISR fires at a pseudo-random subset of the interrupt points,
+// run with --gtest_random_seed=N to try a different interleaving
+namespace {
+
+constexpr uint32_t kIterations = 200000;
+
+std::mt19937 rng;
+callback_t isr_body = nullptr;
+uint32_t isr_calls = 0;
+uint32_t isr_period = 3;
+
+void random_isr() {
+    if (rng() % isr_period != 0) return;
+    isr_calls++;
+    isr_body();
+}
+
+class IrqTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        rng.seed(::testing::UnitTest::GetInstance()->random_seed());
+        isr_calls = 0;
+    }
+
+    void TearDown() override {
+        irq::host::isr = nullptr;
+        irq::host::masked = false;
+    }
+
+    // The ISR fires on average once per `period` interrupt points
+    static void attach(callback_t body, uint32_t period = 3) {
+        isr_body = body;
+        isr_period = period;
+        irq::host::isr = random_isr;
+    }
+};
+
+// Every byte of the pattern is the same, a torn copy mixes two patterns
+uint64_t pattern(uint8_t k) { return 0x0101010101010101ULL * k; }
+bool is_pattern(uint64_t v) { return v == pattern(static_cast<uint8_t>(v)); }
+
+}  // namespace
+
+TEST_F(IrqTest, SimulationTearsUnprotectedCopy) {
+    // Control experiment: without protection a 64-bit copy must get torn
+    static uint64_t shared;
+    static uint8_t k;
+    shared = 0;
+    k = 0;
+    attach([] { shared = pattern(++k); });
+
+    uint32_t torn = 0;
+    for (uint32_t i = 0; i < kIterations; i++) {
+        uint64_t copy;
+        irq::detail::copy(copy, shared);
+        if (!is_pattern(copy)) torn++;
+    }
+    EXPECT_GT(isr_calls, 0u);
+    EXPECT_GT(torn, 0u);
+}
+
+TEST_F(IrqTest, AtomicNeverTears) {
+    static irq::atomic<uint64_t> shared;
+    static uint8_t k;
+    shared.store(0);
+    k = 0;
+    attach([] { shared.store(pattern(++k)); });
+
+    for (uint32_t i = 0; i < kIterations; i++) {
+        irq::interrupt_point();
+        ASSERT_TRUE(is_pattern(shared.load()));
+        irq::interrupt_point();
+        shared.store(pattern(0x5A));
+    }
+    EXPECT_GT(isr_calls, 0u);
+}
+
+TEST_F(IrqTest, AtomicExchangeLosesNoEvents) {
+    // ISR counts events, main loop collects them with exchange()
+    static irq::atomic<uint16_t> pending;
+    static uint32_t produced;
+    pending.store(0);
+    produced = 0;
+    attach([] {
+        pending.store(static_cast<uint16_t>(pending.load() + 1));
+        produced++;
+    });
+
+    uint32_t consumed = 0;
+    for (uint32_t i = 0; i < kIterations; i++) {
+        irq::interrupt_point();
+        consumed += pending.exchange(0);
+    }
+    irq::host::isr = nullptr;
+    consumed += pending.exchange(0);
+    EXPECT_EQ(consumed, produced);
+    EXPECT_GT(produced, 0u);
+}
+
+TEST_F(IrqTest, RingBufferBasics) {
+    irq::ring_buffer<uint8_t, 8> ring;
+    uint8_t v = 0;
+    EXPECT_TRUE(ring.empty());
+    EXPECT_FALSE(ring.pop(v));
+    EXPECT_EQ(ring.space(), 8);
+
+    // Wrap the 8-bit indices several times
+    for (uint16_t round = 0; round < 100; round++) {
+        for (uint8_t i = 0; i < 8; i++) EXPECT_TRUE(ring.push(static_cast<uint8_t>(round + i)));
+        EXPECT_FALSE(ring.push(0xFF));
+        EXPECT_EQ(ring.size(), 8);
+        EXPECT_EQ(ring.space(), 0);
+        for (uint8_t i = 0; i < 8; i++) {
+            ASSERT_TRUE(ring.pop(v));
+            EXPECT_EQ(v, static_cast<uint8_t>(round + i));
+        }
+        EXPECT_TRUE(ring.empty());
+    }
+
+    ring.push(1);
+    ring.push(2);
+    ring.clear();
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST_F(IrqTest, RingBufferIsrProducer) {
+    // Like UART reception: ISR pushes, main loop pops
+    static irq::ring_buffer<uint16_t, 16> ring;
+    static uint16_t next;
+    ring.clear();
+    next = 0;
+    attach([] {
+        if (ring.push(next)) next++;
+    });
+
+    uint16_t expected = 0;
+    for (uint32_t i = 0; i < kIterations; i++) {
+        uint16_t v;
+        irq::interrupt_point();
+        if (ring.pop(v)) {
+            ASSERT_EQ(v, expected);
+            expected++;
+        }
+    }
+    EXPECT_GT(expected, 1000u);
+}
+
+TEST_F(IrqTest, RingBufferIsrConsumer) {
+    // Like UART transmission: main loop pushes, ISR pops
+    static irq::ring_buffer<uint16_t, 16> ring;
+    static uint16_t expected;
+    static bool failed;
+    ring.clear();
+    expected = 0;
+    failed = false;
+    attach([] {
+        uint16_t v;
+        if (ring.pop(v)) {
+            if (v != expected) failed = true;
+            expected++;
+        }
+    });
+
+    uint16_t next = 0;
+    for (uint32_t i = 0; i < kIterations; i++) {
+        irq::interrupt_point();
+        if (ring.push(next)) next++;
+        ASSERT_FALSE(failed);
+    }
+    EXPECT_GT(expected, 1000u);
+}
+
+TEST_F(IrqTest, SeqlockSnapshotIsConsistent) {
+    // Like emulator axis values: ISR writes, main loop reads
+    struct axes_t {
+        int64_t value[5];
+    };
+    static irq::seqlock<axes_t> lock;
+    static int64_t k;
+    k = 0;
+    attach([] {
+        k++;
+        axes_t axes;
+        for (auto& v : axes.value) v = k;
+        lock.store(axes);
+    }, 64);
+
+    int64_t last = 0;
+    for (uint32_t i = 0; i < kIterations; i++) {
+        irq::interrupt_point();
+        axes_t snapshot = lock.load();
+        for (auto v : snapshot.value) ASSERT_EQ(v, snapshot.value[0]);
+        ASSERT_GE(snapshot.value[0], last);
+        last = snapshot.value[0];
+    }
+    EXPECT_GT(last, 0);
+    EXPECT_GT(isr_calls, 1000u);
+}
+
+TEST_F(IrqTest, DoubleBufferFrontIsComplete) {
+    // Like emulator frames: main loop fills and publishes, ISR transmits
+    struct frame_t {
+        uint32_t number;
+        char msg[41];
+    };
+    static irq::double_buffer<frame_t> frames;
+    static uint32_t last_taken;
+    static uint32_t taken;
+    static bool failed;
+    last_taken = 0;
+    taken = 0;
+    failed = false;
+    attach([] {
+        const frame_t& front = frames.front();
+        for (auto c : front.msg) {
+            if (c != static_cast<char>(front.number)) failed = true;
+        }
+        if (frames.take()) {
+            if (front.number < last_taken) failed = true;
+            last_taken = front.number;
+            taken++;
+        }
+    });
+
+    for (uint32_t n = 1; n < kIterations; n++) {
+        frame_t& back = frames.back();
+        back.number = n;
+        for (auto& c : back.msg) {
+            irq::interrupt_point();
+            c = static_cast<char>(n);
+        }
+        frames.publish();
+        ASSERT_FALSE(failed);
+    }
+    EXPECT_GT(taken, 1000u);
+}
@@ -0,0 +1,63 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// Two extra layouts: 3 axes of 6 digits with the dot at 4, 2 axes of 7 digits with the dot at 4
+#define RECEIVER_LAYOUTS 364274ULL
+
+#include <gtest/gtest.h>
+
+#include "layout.h"
+#include "units.h"
+
+TEST(LayoutTest, DecodesCodes) {
+    EXPECT_EQ(layout::COUNT, 3);
+    EXPECT_EQ(layout::at(0), layout::code(AXIS_COUNT, AXIS_DIGIT_COUNT, AXIS_DOT_POSITION));
+    EXPECT_EQ(layout::at(1), 364);
+    EXPECT_EQ(layout::at(2), 274);
+    EXPECT_EQ(layout::axes(274), 2);
+    EXPECT_EQ(layout::digits(274), 7);
+    EXPECT_EQ(layout::dot(274), 4);
+    EXPECT_EQ(layout::count(0), 1);
+    EXPECT_FALSE(layout::valid(layout::code(AXIS_COUNT + 1, 6, 4)));
+    EXPECT_FALSE(layout::valid(layout::code(1, 3, 4)));
+    EXPECT_TRUE(layout::valid(layout::code(1, 3, 0)));
+}
+
+TEST(LayoutTest, SelectsJumpersThenEeprom) {
+    EXPECT_EQ(layout::select(0, 0xFF), 0);  // Nothing set: build layout
+    EXPECT_EQ(layout::select(0, 2), 2);     // EEPROM
+    EXPECT_EQ(layout::select(0, 3), 0);     // EEPROM names no layout
+    EXPECT_EQ(layout::select(1, 2), 1);     // Jumpers win
+    EXPECT_EQ(layout::select(7, 2), 0);     // Jumpers name no layout
+}
+
+TEST(LayoutTest, ConversionFollowsLayout) {
+    // Inch extra digit and clamping come from the layout, not from the build configuration
+    EXPECT_FALSE(units::inch<1>::EXTRA_DIGIT);
+    EXPECT_EQ(units::inch<4>::DOT_POSITION, 3);
+
+    int32_t axis[2] = {999, -254};
+    const uint8_t modes[2] = {units::DIAMETER, units::INCH};
+    units::convert<3, 1>(axis, modes);
+    EXPECT_EQ(axis[0], 999);  // 1998 clamped to 3 digits
+    EXPECT_EQ(axis[1], -10);  // -2.54 mm is -0.10 inch
+
+    int32_t wide[1] = {254000};
+    const uint8_t inch[1] = {units::INCH};
+    units::convert<7, 4>(wide, inch);
+    EXPECT_EQ(wide[0], 100000);  // 254.000 mm is 10.0000 inch
+}
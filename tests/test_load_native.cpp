@@ -0,0 +1,104 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "load.h"
+
+namespace {
+
+// Uptime ticks at 16 MHz
+constexpr uint32_t SECOND = 2000000;
+
+// One slice of a second: the given interrupt and idle ticks, the main loop the rest
+void add(load::meter<4>& m, uint32_t idle, uint32_t timer0 = 0, uint32_t usart_rx = 0, uint32_t length = SECOND) {
+    uint32_t busy[load::COUNT] = {};
+    busy[load::IDLE] = idle;
+    busy[load::TIMER0] = timer0;
+    busy[load::USART_RX] = usart_rx;
+    m.add(length, busy);
+}
+
+std::vector<std::string> report(load::meter<4>& m) {
+    std::vector<std::string> lines;
+    char line[load::LINE_SIZE];
+    while (m.write(line)) {
+        EXPECT_LT(strlen(line), sizeof(line));
+        lines.emplace_back(line);
+    }
+    return lines;
+}
+
+}  // namespace
+
+TEST(LoadTest, SharesOfASlice) {
+    load::meter<4> m;
+    add(m, SECOND / 2, SECOND / 10, SECOND / 100);
+    EXPECT_EQ(m.permille(load::IDLE), 500);
+    EXPECT_EQ(m.permille(load::TIMER0), 100);
+    EXPECT_EQ(m.permille(load::USART_RX), 10);
+    EXPECT_EQ(m.permille(load::MAIN), 390);
+    EXPECT_EQ(m.permille(load::SPI), 0);
+}
+
+TEST(LoadTest, WindowRollsOver) {
+    load::meter<4> m;
+    for (int i = 0; i < 4; i++) add(m, 0);
+    EXPECT_EQ(m.permille(load::MAIN), 1000);
+
+    // Each idle slice replaces the oldest busy one
+    for (int i = 1; i <= 4; i++) {
+        add(m, SECOND);
+        EXPECT_EQ(m.permille(load::IDLE), i * 250);
+    }
+    add(m, SECOND);
+    EXPECT_EQ(m.permille(load::IDLE), 1000);
+    EXPECT_EQ(m.permille(load::MAIN), 0);
+}
+
+TEST(LoadTest, EstimatesNeverExceedTheSlice) {
+    // Interrupts come first; an idle estimate that overshoots takes the rest, the main loop nothing
+    load::meter<4> m;
+    add(m, SECOND, SECOND / 4);
+    EXPECT_EQ(m.permille(load::TIMER0), 250);
+    EXPECT_EQ(m.permille(load::IDLE), 750);
+    EXPECT_EQ(m.permille(load::MAIN), 0);
+
+    // A long slice saturates instead of wrapping
+    load::meter<4> slow;
+    add(slow, 0, 0, 0, 20 * SECOND);
+    EXPECT_EQ(slow.permille(load::MAIN), 1000);
+}
+
+TEST(LoadTest, ReportEveryTenSlices) {
+    load::meter<4> m;
+    for (int i = 0; i < load::REPORT_SLICES - 1; i++) add(m, SECOND / 2, SECOND / 10);
+    EXPECT_FALSE(m.due());
+    EXPECT_TRUE(report(m).empty());
+
+    // Interrupts that did not run in the window are left out
+    add(m, SECOND / 2, SECOND / 10);
+    EXPECT_TRUE(m.due());
+    EXPECT_EQ(report(m), (std::vector<std::string>{"#cm 400\n", "#ci 500\n", "#ct 100\n"}));
+    EXPECT_FALSE(m.due());
+
+    for (int i = 0; i < load::REPORT_SLICES; i++) add(m, 0, 0, SECOND);
+    EXPECT_EQ(report(m), (std::vector<std::string>{"#cm 0\n", "#ci 0\n", "#cr 1000\n"}));
+}
@@ -0,0 +1,112 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <vector>
+
+#include "loopback.h"
+
+namespace {
+
+// Chain of MAX7219 shift registers with DOUT wired back to MISO
+// Bits come back chips * 16 + skew bits late; clocks faster than the limit flip every fifth bit.
+struct chain {
+    chain(uint8_t chips, uint8_t skew, uint8_t fastest_clean) : limit(fastest_clean), registers(chips * 16 + skew) {}
+
+    uint8_t limit;
+    bool wired = true;
+    std::vector<bool> registers;
+    std::vector<uint8_t> rates;
+
+    void operator()(uint8_t rate, const uint8_t* tx, uint8_t* rx, uint8_t size) {
+        rates.push_back(rate);
+        for (uint16_t i = 0; i < size * 8; i++) {
+            bool out = registers.back();
+            registers.pop_back();
+            registers.insert(registers.begin(), loopback::bit(tx, i));
+            if (rate < limit && i % 5 == 0) out = !out;
+            if (!wired) out = true;  // MISO pull-up
+            if (i % 8 == 0) rx[i / 8] = 0;
+            if (out) rx[i / 8] |= static_cast<uint8_t>(0x80 >> (i % 8));
+        }
+    }
+};
+
+}  // namespace
+
+TEST(LoopbackTest, ControlBitsGiveTheDivider) {
+    for (uint8_t rate = 0; rate < loopback::RATE_COUNT; rate++) {
+        const loopback::setting s = loopback::control(rate);
+        const uint32_t spr_divider[4] = {4, 16, 64, 128};
+        EXPECT_EQ(spr_divider[s.spr] >> (s.spi2x ? 1 : 0), loopback::divider(rate)) << int(rate);
+    }
+    EXPECT_EQ(loopback::divider(loopback::SLOWEST), 128u);
+    EXPECT_EQ(loopback::fastest(16000000), 0);  // 8 MHz
+    EXPECT_EQ(loopback::fastest(20000000), 0);  // 10 MHz
+    EXPECT_EQ(loopback::fastest(24000000), 1);
+}
+
+TEST(LoopbackTest, PatternMatchesAtOneDelayOnly) {
+    constexpr uint8_t SIZE = loopback::PATTERN_SIZE + loopback::tail(5);
+    uint8_t tx[SIZE], rx[SIZE];
+    for (uint8_t skew = 0; skew < 3; skew++) {
+        chain c{5, skew, 0};
+        loopback::fill(tx, SIZE, false);
+        c(loopback::SLOWEST, tx, rx, SIZE);
+        EXPECT_EQ(loopback::find_delay(tx, rx, loopback::tail(5) * 8), 80 + skew);
+        for (uint16_t delay = 0; delay <= loopback::tail(5) * 8; delay++) {
+            EXPECT_EQ(loopback::matches(tx, rx, delay), delay == 80 + skew) << delay;
+        }
+    }
+}
+
+TEST(LoopbackTest, KeepsMarginBelowTheFirstFailure) {
+    // Fails at F_CPU / 4: F_CPU / 8 is the fastest clean clock, F_CPU / 16 is kept
+    chain c{3, 1, 2};
+    EXPECT_EQ(loopback::calibrate<3>(0, std::ref(c)), 3);
+    EXPECT_EQ(c.rates.back(), 1);
+    EXPECT_EQ(c.registers, std::vector<bool>(c.registers.size(), false));  // Only no-op frames are latched
+
+    // Clean up to the chips' rating
+    chain fast{3, 1, 0};
+    EXPECT_EQ(loopback::calibrate<3>(0, std::ref(fast)), 0);
+    chain rated{3, 1, 0};
+    EXPECT_EQ(loopback::calibrate<3>(1, std::ref(rated)), 1);
+    EXPECT_EQ(rated.rates.back(), 1);
+
+    // Shorter chain than the layout: the delay is found anyway
+    chain short_chain{2, 1, 4};
+    EXPECT_EQ(loopback::calibrate<5>(0, std::ref(short_chain)), 5);
+
+    // Failing at the slowest clock: no rate
+    chain slow{3, 1, loopback::RATE_COUNT};
+    EXPECT_EQ(loopback::calibrate<3>(0, std::ref(slow)), loopback::NONE);
+}
+
+TEST(LoopbackTest, WithoutLoopbackFallsBackToEeprom) {
+    chain open{3, 1, 0};
+    open.wired = false;
+    EXPECT_EQ(loopback::calibrate<3>(0, std::ref(open)), loopback::NONE);
+    EXPECT_EQ(open.rates.size(), 1u);
+
+    EXPECT_EQ(loopback::select(2, 0xFF, 0), 2);                                // Calibrated
+    EXPECT_EQ(loopback::select(loopback::NONE, 3, 0), 3);                      // EEPROM
+    EXPECT_EQ(loopback::select(loopback::NONE, 0xFF, 0), loopback::SLOWEST);  // Erased
+    EXPECT_EQ(loopback::select(loopback::NONE, 0, 1), loopback::SLOWEST);     // Faster than the chips take
+}
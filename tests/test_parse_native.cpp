@@ -0,0 +1,75 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "format.h"
+#include "parse.h"
+
+namespace {
+
+template <size_t N, int D, int P>
+void round_trip(uint32_t seed) {
+    std::mt19937 rng(seed);
+    int64_t max = 1;
+    for (int i = 0; i < D; i++) max *= 10;
+    std::uniform_int_distribution<int64_t> dist(-(max - 1), max - 1);
+    for (int i = 0; i < 10000; i++) {
+        int64_t in[N];
+        for (auto& v : in) v = dist(rng);
+        char line[N * 10 + 1];
+        format<N, D, P>(in, line);
+
+        int32_t out[N];
+        ASSERT_TRUE((parse<N, D, P>(line, out))) << line;
+        for (size_t j = 0; j < N; j++) ASSERT_EQ(out[j], in[j]) << line;
+    }
+}
+
+}  // namespace
+
+TEST(ParseTest, RoundTripsFormat) {
+    round_trip<4, 6, 4>(1);
+    round_trip<1, 7, 3>(2);
+    round_trip<5, 3, 1>(3);
+    round_trip<3, 4, 4>(4);
+}
+
+TEST(ParseTest, AcceptsLineWithoutNewline) {
+    int32_t axis[2];
+    ASSERT_TRUE((parse<2, 6, 4>("   -12.34:    1.00", axis)));
+    EXPECT_EQ(axis[0], -1234);
+    EXPECT_EQ(axis[1], 100);
+}
+
+TEST(ParseTest, RejectsMalformedLines) {
+    int32_t axis[2];
+    EXPECT_FALSE((parse<2, 6, 4>("", axis)));
+    EXPECT_FALSE((parse<2, 6, 4>("   12.3400:    1.00", axis)));         // Wrong number of decimals
+    EXPECT_FALSE((parse<2, 6, 4>("   12.34", axis)));                    // Missing axis
+    EXPECT_FALSE((parse<2, 6, 4>("   12.34:    1.00:    1.00", axis)));  // Extra axis
+    EXPECT_FALSE((parse<2, 6, 4>("   12.34;    1.00", axis)));           // Wrong separator
+    EXPECT_FALSE((parse<2, 6, 4>("   12.x4:    1.00", axis)));
+    EXPECT_FALSE((parse<2, 6, 4>("#t0000abcd", axis)));
+    EXPECT_FALSE((parse<2, 6, 4>("    -.  :    1.00", axis)));
+    EXPECT_FALSE((parse<2, 6, 4>(" 12345.67:    1.00", axis)));          // More digits than the layout
+
+    int32_t wide[1];
+    EXPECT_FALSE((parse<1, 7, 3>("-9999.9999", wide)));
+    EXPECT_TRUE((parse<1, 7, 3>("-999.9999", wide)));
+    EXPECT_EQ(wide[0], -9999999);
+}
@@ -0,0 +1,157 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "bus.h"
+#include "raw.h"
+
+namespace {
+
+// Byte queue with a fixed amount of free space, like the sampler ring
+struct sink_t {
+    std::vector<uint8_t> bytes;
+    size_t capacity = SIZE_MAX;
+
+    uint8_t space() const {
+        size_t free = capacity - bytes.size();
+        return static_cast<uint8_t>(free < 255 ? free : 255);
+    }
+    void push(uint8_t byte) { bytes.push_back(byte); }
+};
+
+// Pins of every sample, rebuilt from the stream; dropped samples repeat the last pins
+std::vector<uint16_t> replay(const std::vector<uint8_t>& bytes, uint32_t& dropped) {
+    std::vector<uint16_t> samples;
+    raw::decoder decoder;
+    uint16_t last = raw::snapshot(0, bus::IDLE);
+    dropped = 0;
+    for (uint8_t byte : bytes) {
+        switch (decoder.feed(byte)) {
+            case raw::decoder::RUN:
+                last = raw::snapshot(decoder.pind(), decoder.pinc());
+                samples.insert(samples.end(), decoder.samples(), last);
+                break;
+            case raw::decoder::DROPPED:
+                dropped += decoder.samples();
+                samples.insert(samples.end(), decoder.samples(), last);
+                break;
+            default:
+                break;
+        }
+    }
+    return samples;
+}
+
+}  // namespace
+
+TEST(RawTest, SnapshotKeepsBusPins) {
+    for (unsigned pind = 0; pind < 256; pind += 4) {
+        for (unsigned pinc = 0; pinc < 64; pinc++) {
+            uint16_t pins = raw::snapshot(static_cast<uint8_t>(pind | 0x03), static_cast<uint8_t>(pinc | 0xC0));
+            ASSERT_EQ(raw::pind_of(pins), pind);
+            ASSERT_EQ(raw::pinc_of(pins), pinc);
+        }
+    }
+}
+
+TEST(RawTest, StreamRebuildsTheBusWaveform) {
+    // Four samples per scanner tick, the stream is decoded like a capture
+    bus::scanner<3, 5> scanner;
+    int64_t in[3] = {12345, -6789, 0};
+    bus::frame<3, 5> frame;
+    bus::encode(in, frame);
+    scanner.load(frame);
+
+    raw::encoder encoder;
+    sink_t sink;
+    std::vector<uint16_t> sent;
+    uint8_t portd = 0, portc = bus::IDLE;
+    for (int tick = 0; tick < bus::scanner<3, 5>::TICKS_PER_FRAME * 5; tick++) {
+        scanner.tick(portd, portc);
+        for (int i = 0; i < 4; i++) {
+            sent.push_back(raw::snapshot(portd, portc));
+            encoder.sample(sent.back(), sink);
+        }
+    }
+    encoder.sample(static_cast<uint16_t>(~sent.back()), sink);  // Flush the last run
+    EXPECT_EQ(encoder.dropped(), 0u);
+    EXPECT_LT(sink.bytes.size(), sent.size());
+
+    uint32_t dropped;
+    EXPECT_EQ(replay(sink.bytes, dropped), sent);
+    EXPECT_EQ(dropped, 0u);
+
+    bus::decoder<3, 5> decoder;
+    int frames = 0;
+    for (uint16_t pins : sent) frames += decoder.sample(raw::pind_of(pins), raw::pinc_of(pins)) ? 1 : 0;
+    EXPECT_GE(frames, 4);
+    int64_t out[3];
+    ASSERT_TRUE(bus::decode(decoder.last(), out));
+    for (int i = 0; i < 3; i++) EXPECT_EQ(out[i], in[i]);
+}
+
+TEST(RawTest, LongRunsAreSplit) {
+    raw::encoder encoder;
+    sink_t sink;
+    for (int i = 0; i < 1000; i++) encoder.sample(0x0102, sink);
+    encoder.sample(0, sink);
+    EXPECT_EQ(sink.bytes.size(), (1000 + raw::MAX_RUN - 1) / raw::MAX_RUN * raw::RECORD_SIZE);
+    uint32_t dropped;
+    EXPECT_EQ(replay(sink.bytes, dropped).size(), 1000u);
+}
+
+TEST(RawTest, DroppedSamplesAreCounted) {
+    raw::encoder encoder;
+    sink_t sink;
+    sink.capacity = raw::RECORD_SIZE;
+    encoder.sample(1, sink);
+    encoder.sample(2, sink);  // Run of 1 fills the sink
+    encoder.sample(3, sink);  // Run of 2 is dropped
+    encoder.sample(3, sink);
+    encoder.sample(4, sink);  // Run of 3 x 2 is dropped
+    EXPECT_TRUE(encoder.dropping());
+    EXPECT_EQ(encoder.dropped(), 3u);
+
+    // Room again: the drop record goes out ahead of the next run
+    sink.capacity = SIZE_MAX;
+    encoder.sample(5, sink);
+    EXPECT_FALSE(encoder.dropping());
+    uint32_t dropped;
+    std::vector<uint16_t> samples = replay(sink.bytes, dropped);
+    EXPECT_EQ(dropped, 3u);
+    EXPECT_EQ(samples, (std::vector<uint16_t>{1, 1, 1, 1, 4}));
+}
+
+TEST(RawTest, DecoderResynchronises) {
+    raw::encoder encoder;
+    sink_t sink;
+    const char header[] = "#r00002710\n";
+    sink.bytes.assign(header, header + sizeof(header) - 1);
+    for (uint16_t pins : {0x0101, 0x0202, 0x0303}) encoder.sample(pins, sink);
+    encoder.sample(0, sink);
+    sink.bytes.erase(sink.bytes.begin() + 11 + 4);  // Lose a byte of the second record
+
+    raw::decoder decoder;
+    std::vector<uint8_t> pinc;
+    for (uint8_t byte : sink.bytes) {
+        if (decoder.feed(byte) == raw::decoder::RUN) pinc.push_back(decoder.pinc());
+    }
+    EXPECT_EQ(pinc, (std::vector<uint8_t>{1, 3}));
+    EXPECT_EQ(decoder.skipped(), 11u + 2u);
+}
@@ -0,0 +1,122 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "histogram.h"
+#include "stamp.h"
+
+namespace {
+
+uint8_t reference_bucket(uint32_t value) {
+    uint8_t bits = 0;
+    while (value) {
+        bits++;
+        value >>= 1;
+    }
+    return bits;
+}
+
+}  // namespace
+
+TEST(HistogramTest, BucketIsBitLength) {
+    EXPECT_EQ(histogram::bucket(0), 0);
+    for (uint8_t bit = 0; bit < 32; bit++) {
+        uint32_t power = static_cast<uint32_t>(1) << bit;
+        EXPECT_EQ(histogram::bucket(power), bit + 1);
+        EXPECT_EQ(histogram::bucket(power - 1), bit);
+        EXPECT_EQ(histogram::bucket(power | (power - 1)), bit + 1);
+    }
+    std::mt19937 rng(1);
+    for (int i = 0; i < 1000000; i++) {
+        uint32_t value = rng() >> (rng() % 32);
+        ASSERT_EQ(histogram::bucket(value), reference_bucket(value)) << value;
+    }
+}
+
+TEST(HistogramTest, CountsAndSaturates) {
+    histogram::log2<8> h;
+    h.add(0);
+    h.add(1);
+    h.add(5);
+    h.add(7);
+    h.add(1000000);  // Above the last bucket
+    EXPECT_EQ(h.count[0], 1);
+    EXPECT_EQ(h.count[1], 1);
+    EXPECT_EQ(h.count[3], 2);
+    EXPECT_EQ(h.count[7], 1);
+    EXPECT_EQ(histogram::log2<8>::lower_bound(3), 4u);
+
+    for (int i = 0; i < 70000; i++) h.add(2);
+    EXPECT_EQ(h.count[2], UINT16_MAX);
+    h.clear();
+    for (auto c : h.count) EXPECT_EQ(c, 0);
+}
+
+TEST(StampTest, WriteParseRoundTrip) {
+    const uint32_t values[] = {0, 1, 0x89abcdef, 0xffffffff, 0x00c0ffee};
+    for (uint32_t value : values) {
+        char line[stamp::LINE_SIZE + 1];
+        char* end = stamp::write(line, stamp::TIME, value);
+        ASSERT_EQ(end - line, static_cast<ptrdiff_t>(stamp::LINE_SIZE));
+        EXPECT_EQ(end[-1], '\n');
+        end[-1] = '\0';  // As returned by the receiver
+
+        char tag = 0;
+        uint32_t parsed = 0;
+        ASSERT_TRUE(stamp::parse(line, tag, parsed));
+        EXPECT_EQ(tag, stamp::TIME);
+        EXPECT_EQ(parsed, value);
+    }
+}
+
+TEST(StampTest, ParseRejectsOtherLines) {
+    char tag;
+    uint32_t value;
+    EXPECT_FALSE(stamp::parse("   12.3456:    0.0000", tag, value));
+    EXPECT_FALSE(stamp::parse("#hi 3 10", tag, value));
+    EXPECT_FALSE(stamp::parse("#t1234567", tag, value));
+    EXPECT_FALSE(stamp::parse("#t123456789", tag, value));
+    EXPECT_FALSE(stamp::parse("#t1234567G", tag, value));
+    EXPECT_TRUE(stamp::parse("#s0000abcd", tag, value));
+    EXPECT_EQ(tag, stamp::SYNC);
+    EXPECT_EQ(value, 0xabcdu);
+}
+
+TEST(StampTest, ClockSyncTakesWindowMinimum) {
+    // Receiver clock is 1000 ticks ahead, queueing adds 0..300 ticks, wire time 50 ticks
+    stamp::clock_sync sync;
+    const uint32_t queue[] = {300, 20, 150, 0, 80, 250, 10, 40};
+    uint32_t sent = 0xfffff000;  // Wraps during the test
+    for (uint8_t i = 0; i < stamp::clock_sync::WINDOW; i++) {
+        EXPECT_FALSE(sync.valid());
+        sync.add(sent, sent + 1000 + 50 + queue[i], 50);
+        sent += 2000000;
+    }
+    ASSERT_TRUE(sync.valid());
+    EXPECT_EQ(sync.offset(), 1000);
+    EXPECT_EQ(sync.to_local(0xffffff00), 0x2e8u);
+
+    // Next window follows drift, the old estimate stays until it is complete
+    for (uint8_t i = 0; i < stamp::clock_sync::WINDOW; i++) {
+        sync.add(sent, sent + 1010 + 50 + queue[i], 50);
+        if (i + 1 < stamp::clock_sync::WINDOW) {
+            EXPECT_EQ(sync.offset(), 1000);
+        }
+    }
+    EXPECT_EQ(sync.offset(), 1010);
+}
@@ -0,0 +1,127 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include <string>
+#include <vector>
+
+#include "gcode.h"
+#include "toolpath.h"
+
+namespace {
+
+constexpr size_t AXES = 3;
+
+// Compile a program for three axes with 0.01 mm units at 50 frames per second
+gcode::interpreter compile(const std::string& program) {
+    gcode::settings s;
+    s.units_per_mm = 100;
+    s.frame_rate = 50;
+    gcode::interpreter interpreter(s, AXES);
+    std::string error;
+    EXPECT_TRUE(interpreter.run(program.data(), program.data() + program.size(), error)) << error;
+    return interpreter;
+}
+
+// Every frame of the playback must show the sample of that frame, give or take the tolerance
+void expect_playback(const std::vector<int32_t>& samples, const std::vector<uint8_t>& stream, int32_t tolerance = 0) {
+    toolpath::player<AXES> player(stream.data());
+    const size_t frames = samples.size() / AXES;
+    for (size_t frame = 0; frame < frames; frame++) {
+        for (size_t i = 0; i < AXES; i++) {
+            ASSERT_LE(abs(player[i] - samples[frame * AXES + i]), tolerance) << "frame " << frame << " axis " << i;
+        }
+        player.step();
+    }
+    EXPECT_TRUE(player.finished());
+}
+
+}  // namespace
+
+TEST(ToolpathTest, ZigzagRoundTrip) {
+    for (int32_t v : {0, 1, -1, 63, -64, 1000000, -1000000, INT32_MAX, INT32_MIN}) {
+        EXPECT_EQ(toolpath::unzigzag(toolpath::zigzag(v)), v);
+    }
+    EXPECT_EQ(toolpath::zigzag(-1), 1u);
+}
+
+TEST(ToolpathTest, LinesAtFeedRate) {
+    // 60 mm at 600 mm/min: 6 s, 300 frames, one record
+    auto program = compile("G21 G90\nG1 F600 X60\n");
+    ASSERT_EQ(program.frames(), 301u);
+    EXPECT_EQ(program.samples()[150 * AXES], 3000);
+    EXPECT_EQ(program.samples()[300 * AXES], 6000);
+
+    size_t records;
+    std::vector<uint8_t> stream = gcode::encode(program.samples(), AXES, 0, &records);
+    EXPECT_EQ(records, 1u);
+    EXPECT_LT(stream.size(), 12u);
+    expect_playback(program.samples(), stream);
+}
+
+TEST(ToolpathTest, IncrementalInchAndDwell) {
+    auto program = compile("G20 G91 G0 X1 Y-0.5\nG4 P1\nG1 F10 Z0.1\nM30\nG1 X100\n");
+    const std::vector<int32_t>& s = program.samples();
+    const size_t last = program.frames() - 1;
+    EXPECT_EQ(s[last * AXES + 0], 2540);
+    EXPECT_EQ(s[last * AXES + 1], -1270);
+    EXPECT_EQ(s[last * AXES + 2], 254);
+    expect_playback(s, gcode::encode(s, AXES));
+}
+
+TEST(ToolpathTest, ArcsFollowTheCircle) {
+    // Same half circle of radius 10 around (10, 0), with I J and with R
+    auto ij = compile("G1 F300 X0 Y0\nG2 X20 Y0 I10 J0\n");
+    auto r = compile("G1 F300 X0 Y0\nG2 X20 Y0 R10\n");
+    ASSERT_EQ(ij.samples(), r.samples());
+
+    const std::vector<int32_t>& s = ij.samples();
+    for (size_t frame = 0; frame < ij.frames(); frame++) {
+        double x = s[frame * AXES] / 100.0 - 10, y = s[frame * AXES + 1] / 100.0;
+        ASSERT_NEAR(hypot(x, y), 10, 0.01);
+        ASSERT_GE(y, -0.005);  // Clockwise from (0, 0) passes over the top
+    }
+    expect_playback(s, gcode::encode(s, AXES));
+}
+
+TEST(ToolpathTest, ErrorsNameTheLine) {
+    gcode::interpreter interpreter(gcode::settings(), AXES);
+    std::string error;
+    const std::string program = "G0 X1\nG1 X2\n";
+    EXPECT_FALSE(interpreter.run(program.data(), program.data() + program.size(), error));
+    EXPECT_EQ(error, "line 2: feed rate is not set");
+}
+
+TEST(ToolpathTest, HalfHourJobFitsTheFlashBudget) {
+    // 30 pocket contours: 80 x 50 mm with 5 mm corner radii at 250 mm/min, 1 mm deeper each time
+    std::string program = "G21 G90 G0 X5 Y0 Z1\n";
+    for (int pass = 1; pass <= 30; pass++) {
+        program += "G1 F100 Z-" + std::to_string(pass) + "\nF250\n";
+        program += "G1 X75\nG3 X80 Y5 R5\nG1 Y45\nG3 X75 Y50 R5\n";
+        program += "G1 X5\nG3 X0 Y45 R5\nG1 Y5\nG3 X5 Y0 R5\n";
+    }
+    program += "G0 Z1\nM30\n";
+    auto job = compile(program);
+    EXPECT_GT(job.frames(), 30u * 60 * 50);
+
+    // Half of the flash for the toolpath, when every frame may be one unit off
+    std::vector<uint8_t> stream = gcode::encode(job.samples(), AXES, 1);
+    EXPECT_LT(stream.size(), 16u * 1024);
+    expect_playback(job.samples(), stream, 1);
+}
@@ -0,0 +1,71 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+
+#include "units.h"
+
+namespace {
+
+// round(value * num / den) with halves away from zero, in plain 64 bit arithmetic
+int64_t reference(int64_t value, int64_t num, int64_t den) {
+    int64_t magnitude = value < 0 ? -value : value;
+    int64_t q = (magnitude * num * 2 + den) / (den * 2);
+    return value < 0 ? -q : q;
+}
+
+void check_all(uint32_t num, uint32_t den) {
+    const units::ratio r = units::make_ratio(num, den);
+    ASSERT_TRUE(r.valid);
+    for (int32_t value = -static_cast<int32_t>(units::MAX_MAGNITUDE);
+         value <= static_cast<int32_t>(units::MAX_MAGNITUDE); value++) {
+        ASSERT_EQ(units::scale(value, r), reference(value, num, den)) << value << " * " << num << " / " << den;
+    }
+}
+
+}  // namespace
+
+TEST(UnitsTest, ModesExhaustive) {
+    check_all(1, 1);
+    check_all(units::INCH_NUM, units::INCH_DEN);
+    check_all(2, 1);
+    check_all(2 * units::INCH_NUM, units::INCH_DEN);
+}
+
+TEST(UnitsTest, OtherRatiosExhaustive) {
+    // Even denominators have exact halves, large ones need the longest shift
+    check_all(1, 2);
+    check_all(127, 50);
+    check_all(7, 65535);
+    check_all(400, 999983);
+}
+
+TEST(UnitsTest, RatioLimits) {
+    EXPECT_FALSE(units::make_ratio(0, 1).valid);
+    EXPECT_FALSE(units::make_ratio(1, 0).valid);
+    EXPECT_FALSE(units::make_ratio(1000, 3).valid);  // Numerator overflows 32 bits
+    EXPECT_TRUE(units::make_ratio(428, 3).valid);
+    EXPECT_GE(units::make_ratio(5, 127).shift, 32);
+}
+
+TEST(UnitsTest, ConvertClampsAndSelectsPerAxis) {
+    int32_t axis[4] = {1270, -1270, 6000000, -6000000};
+    const uint8_t modes[4] = {units::INCH, units::MM, units::DIAMETER, units::DIAMETER};
+    units::convert(axis, modes);
+    EXPECT_EQ(axis[0], units::INCH_EXTRA_DIGIT ? 500 : 50);
+    EXPECT_EQ(axis[1], -1270);
+    EXPECT_EQ(axis[2], MAX_AXIS);
+    EXPECT_EQ(axis[3], MIN_AXIS);
+}
@@ -0,0 +1,97 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "irq.h"
+#include "urgent.h"
+
+namespace {
+
+// Send everything through the scheduler and return what went on the wire
+template <typename Urgent, typename Normal>
+std::string wire(urgent::scheduler& scheduler, Urgent& urgent_queue, Normal& normal_queue, size_t bytes = SIZE_MAX) {
+    std::string out;
+    char c;
+    while (out.size() < bytes && scheduler.next(urgent_queue, normal_queue, c)) out += c;
+    return out;
+}
+
+template <typename Queue>
+void queue(Queue& q, const char* line) {
+    while (*line) ASSERT_TRUE(q.push(*line++));
+}
+
+}  // namespace
+
+TEST(UrgentTest, StatusLineRoundTrip) {
+    char line[urgent::LINE_SIZE + 1];
+    for (uint8_t status = 0; status <= (urgent::ER | urgent::A7); status++) {
+        char* end = urgent::write(line, status, 0x12ab34cdu);
+        ASSERT_EQ(end - line, static_cast<ptrdiff_t>(urgent::LINE_SIZE));
+        EXPECT_EQ(line[0], urgent::PREFIX);
+        EXPECT_EQ(end[-1], '\n');
+        end[-1] = '\0';
+
+        uint8_t parsed_status;
+        uint32_t parsed_time;
+        ASSERT_TRUE(urgent::parse(line, parsed_status, parsed_time));
+        EXPECT_EQ(parsed_status, status);
+        EXPECT_EQ(parsed_time, 0x12ab34cdu);
+    }
+}
+
+TEST(UrgentTest, ParseRejectsOtherLines) {
+    uint8_t status;
+    uint32_t time;
+    EXPECT_FALSE(urgent::parse("#t12ab34cd", status, time));
+    EXPECT_FALSE(urgent::parse("!412ab34cd", status, time));
+    EXPECT_FALSE(urgent::parse("!112ab34c", status, time));
+    EXPECT_FALSE(urgent::parse("   12.3456:    0.0000", status, time));
+}
+
+TEST(UrgentTest, StatusFromPins) {
+    EXPECT_EQ(urgent::status_of(0), 0);
+    EXPECT_EQ(urgent::status_of(bus::ER_MASK | bus::W_MASK), urgent::ER);
+    EXPECT_EQ(urgent::status_of(bus::A7_MASK | 0x03), urgent::A7);
+    for (uint8_t status = 0; status <= (urgent::ER | urgent::A7); status++) {
+        EXPECT_EQ(urgent::status_of(urgent::pins_of(status)), status);
+    }
+}
+
+TEST(UrgentTest, UrgentLineWaitsForTheLineOnTheWire) {
+    urgent::scheduler scheduler;
+    irq::ring_buffer<char, 16> urgent_queue;
+    irq::ring_buffer<char, 64> normal_queue;
+    queue(normal_queue, "#t00000010\n   1.0000:   2.0000\n");
+
+    // Status changes while the time stamp line is going out
+    std::string out = wire(scheduler, urgent_queue, normal_queue, 4);
+    queue(urgent_queue, "!100000020\n");
+    out += wire(scheduler, urgent_queue, normal_queue);
+    EXPECT_EQ(out, "#t00000010\n!100000020\n   1.0000:   2.0000\n");
+}
+
+TEST(UrgentTest, IdleLinkSendsUrgentLineFirst) {
+    urgent::scheduler scheduler;
+    irq::ring_buffer<char, 16> urgent_queue;
+    irq::ring_buffer<char, 64> normal_queue;
+    queue(normal_queue, "   1.0000\n");
+    queue(urgent_queue, "!000000020\n");
+    EXPECT_EQ(wire(scheduler, urgent_queue, normal_queue), "!000000020\n   1.0000\n");
+}
@@ -0,0 +1,342 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// Position history archive tool (see archive.h)
+//
+// Usage: razmer2m_archive pack [-a] [-s US] archive [lines]
+//          store the link lines of a transmitter or emulator (stdin by default); data lines get the
+//          time of the "#t" line before them, counted from US in microseconds (default 0, or a frame
+//          after the last one when appending)
+//          -a    append to an existing archive
+//        razmer2m_archive query [-f US] [-t US] archive
+//          print the frames from US (inclusive) to US (exclusive) as "time<TAB>data line"
+//        razmer2m_archive info archive
+//        razmer2m_archive bench [-d DAYS] archive
+//          write DAYS (default 30) of a synthetic machine at FRAME_RATE to the archive and report
+//          bytes per frame, ingest rate and query latency
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "archive.h"
+#include "config.h"
+#include "format.h"
+#include "parse.h"
+#include "stamp.h"
+
+namespace {
+
+// Ticks of the "#t" time stamps (see uptime.h, F_CPU / 8 at 16 MHz)
+constexpr uint32_t TICKS_PER_US = 2;
+
+// Data line and time stamp line, as they are on the link
+constexpr size_t LINE_BYTES = AXIS_COUNT * 10 + 1 + stamp::LINE_SIZE;
+
+constexpr archive::layout LINES = {AXIS_COUNT, AXIS_DIGIT_COUNT, AXIS_DOT_POSITION};
+
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start) {
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+void usage() {
+    fputs("usage: razmer2m_archive pack [-a] [-s US] archive [lines]\n"
+          "       razmer2m_archive query [-f US] [-t US] archive\n"
+          "       razmer2m_archive info archive\n"
+          "       razmer2m_archive bench [-d DAYS] archive\n",
+          stderr);
+}
+
+bool check_layout(const archive::reader& reader, const char* path) {
+    archive::layout lines = reader.lines();
+    if (lines.axes == LINES.axes && lines.digits == LINES.digits && lines.dot == LINES.dot) return true;
+    fprintf(stderr, "%s: archive of %u axes of %u digits (dot %u), this tool is built for %u, %u (dot %u)\n", path,
+            lines.axes, lines.digits, lines.dot, LINES.axes, LINES.digits, LINES.dot);
+    return false;
+}
+
+int pack(const char* path, const char* input, bool append, const int64_t* start) {
+    FILE* in = input ? fopen(input, "r") : stdin;
+    if (!in) {
+        fprintf(stderr, "cannot open %s\n", input);
+        return 1;
+    }
+
+    std::string error;
+    archive::writer writer;
+    if (append ? !writer.append(path, LINES, error) : !writer.create(path, LINES, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    // Appended lines go on a frame after the archive, unless told otherwise
+    int64_t start_us = 0;
+    if (start) {
+        start_us = *start;
+    } else if (writer.last_time() != INT64_MIN) {
+        start_us = writer.last_time() + 1000000 / FRAME_RATE;
+    }
+
+    // Time stamps are 32 bit ticks that wrap, lines without one are a frame after the last
+    char line[256];
+    uint32_t ticks = 0;
+    int64_t time_us = start_us, elapsed_ticks = 0;
+    bool stamped = false;
+    uint64_t lines = 0, skipped = 0;
+    archive::frame f = {};
+    while (fgets(line, sizeof(line), in)) {
+        lines++;
+        line[strcspn(line, "\r\n")] = '\0';
+        char tag;
+        uint32_t value;
+        if (stamp::parse(line, tag, value)) {
+            if (tag != stamp::TIME) continue;
+            if (stamped) elapsed_ticks += static_cast<int64_t>(value - ticks);
+            ticks = value;
+            stamped = true;
+            time_us = start_us + elapsed_ticks / TICKS_PER_US;
+            continue;
+        }
+        int32_t axis[AXIS_COUNT];
+        if (!parse(line, axis)) {
+            skipped++;
+            continue;
+        }
+        f.time_us = time_us;
+        for (size_t i = 0; i < AXIS_COUNT; i++) f.axis[i] = axis[i];
+        if (!writer.add(f, error)) {
+            fprintf(stderr, "%s: line %llu: %s\n", path, static_cast<unsigned long long>(lines), error.c_str());
+            return 1;
+        }
+        time_us += 1000000 / FRAME_RATE;
+    }
+    if (in != stdin) fclose(in);
+    if (!writer.close(error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    fprintf(stderr, "%s: %llu frames added, %llu bytes, %llu lines skipped\n", path,
+            static_cast<unsigned long long>(writer.frames()), static_cast<unsigned long long>(writer.bytes()),
+            static_cast<unsigned long long>(skipped));
+    return 0;
+}
+
+int query(const char* path, int64_t from_us, int64_t to_us) {
+    std::string error;
+    archive::reader reader;
+    if (!reader.open(path, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    if (!check_layout(reader, path)) return 1;
+
+    static char out_buffer[1 << 20];
+    setvbuf(stdout, out_buffer, _IOFBF, sizeof(out_buffer));
+    char line[AXIS_COUNT * 10 + 1];
+    int64_t axis[AXIS_COUNT];
+    bool ok = reader.query(
+        from_us, to_us,
+        [&](const archive::frame& f) {
+            for (size_t i = 0; i < AXIS_COUNT; i++) axis[i] = f.axis[i];
+            format(axis, line);
+            printf("%lld\t%s", static_cast<long long>(f.time_us), line);
+        },
+        error);
+    fflush(stdout);
+    if (!ok) fprintf(stderr, "%s: %s\n", path, error.c_str());
+    return ok ? 0 : 1;
+}
+
+int info(const char* path) {
+    std::string error;
+    archive::reader reader;
+    if (!reader.open(path, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    archive::layout lines = reader.lines();
+    const auto& blocks = reader.blocks();
+    const uint64_t frames = reader.frames();
+    printf("%s: %u axes of %u digits (dot %u), %zu blocks, %llu frames\n", path, lines.axes, lines.digits, lines.dot,
+           blocks.size(), static_cast<unsigned long long>(frames));
+    if (!blocks.empty()) {
+        const int64_t first = blocks.front().first_us, last = blocks.back().last_us;
+        printf("  time     %lld .. %lld us (%.1f hours)\n", static_cast<long long>(first),
+               static_cast<long long>(last), (last - first) / 3.6e9);
+        printf("  blocks   %.2f bytes per frame\n", static_cast<double>(reader.blocks_end()) / frames);
+    }
+    return 0;
+}
+
+// A machine that stands still for minutes, then runs straight moves of one or two axes at a feed rate
+class synthetic_machine {
+   public:
+    explicit synthetic_machine(uint32_t seed) : rng(seed) { plan(); }
+
+    void next(archive::frame& f) {
+        f.time_us = time_us;
+        time_us += 1000000 / FRAME_RATE + static_cast<int64_t>(rng() % 41) - 20;  // Stamp jitter
+        for (size_t i = 0; i < AXIS_COUNT; i++) {
+            position[i] += speed[i];
+            f.axis[i] = static_cast<int32_t>(position[i]);
+        }
+        if (--remaining == 0) plan();
+    }
+
+   private:
+    void plan() {
+        for (double& s : speed) s = 0;
+        if (rng() % 2) {
+            remaining = FRAME_RATE * (60 + rng() % 1200);  // Idle 1 to 21 minutes
+            return;
+        }
+        // 1 to 60 seconds at 50 to 2000 mm/min in displayed units per frame, away from the limits
+        remaining = FRAME_RATE * (1 + rng() % 60);
+        const double limit = static_cast<double>(MAX_AXIS_ABS) / 2;
+        for (uint32_t n = 1 + rng() % 2; n > 0; n--) {
+            size_t axis = rng() % AXIS_COUNT;
+            double units = (50 + rng() % 1950) / 60.0 / FRAME_RATE * units_per_mm();
+            speed[axis] = position[axis] > 0 ? -units : units;
+            if (position[axis] + speed[axis] * remaining > limit) speed[axis] = 0;
+            if (position[axis] + speed[axis] * remaining < -limit) speed[axis] = 0;
+        }
+    }
+
+    static double units_per_mm() {
+        double units = 1;
+        for (int i = AXIS_DOT_POSITION; i < AXIS_DIGIT_COUNT; i++) units *= 10;
+        return units;
+    }
+
+    std::mt19937 rng;
+    int64_t time_us = 0;
+    double position[AXIS_COUNT] = {};
+    double speed[AXIS_COUNT] = {};
+    uint32_t remaining = 0;
+};
+
+// Mean time of random queries of a duration, and the blocks they decoded
+void bench_queries(const archive::reader& reader, int64_t end_us, int64_t duration_us, int count, const char* name) {
+    std::mt19937_64 rng(1);
+    std::string error;
+    uint64_t frames = 0;
+    size_t blocks = 0, decoded;
+    auto start = clock_type::now();
+    for (int i = 0; i < count; i++) {
+        int64_t from = static_cast<int64_t>(rng() % static_cast<uint64_t>(end_us - duration_us));
+        reader.query(from, from + duration_us, [&](const archive::frame&) { frames++; }, error, &decoded);
+        blocks += decoded;
+    }
+    double seconds = seconds_since(start);
+    printf("  query %-8s %9.1f us, %6.1f blocks, %8.0f frames\n", name, seconds * 1e6 / count,
+           static_cast<double>(blocks) / count, static_cast<double>(frames) / count);
+}
+
+int bench(const char* path, int days) {
+    const uint64_t frames = static_cast<uint64_t>(days) * 86400 * FRAME_RATE;
+    std::string error;
+    archive::writer writer;
+    if (!writer.create(path, LINES, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    synthetic_machine machine(2025);
+    archive::frame f = {};
+    auto start = clock_type::now();
+    for (uint64_t i = 0; i < frames; i++) {
+        machine.next(f);
+        if (!writer.add(f, error)) break;
+    }
+    if (!writer.close(error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    double seconds = seconds_since(start);
+    const int64_t end_us = f.time_us;
+
+    printf("%s: %d days at %d frames per second, %u axes of %u digits (dot %u)\n", path, days, FRAME_RATE, LINES.axes,
+           LINES.digits, LINES.dot);
+    printf("  %llu frames, %llu bytes: %.2f bytes per frame (%zu on the link), %.1f MB per machine and week\n",
+           static_cast<unsigned long long>(frames), static_cast<unsigned long long>(writer.bytes()),
+           static_cast<double>(writer.bytes()) / frames, LINE_BYTES,
+           static_cast<double>(writer.bytes()) / days * 7 / 1e6);
+    printf("  ingest %.1f M frames per second (%.1f ns per frame, with the synthetic machine)\n",
+           frames / seconds / 1e6, seconds * 1e9 / frames);
+
+    start = clock_type::now();
+    archive::reader reader;
+    if (!reader.open(path, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    printf("  open   %11.1f us (%zu index entries)\n", seconds_since(start) * 1e6, reader.blocks().size());
+    bench_queries(reader, end_us, 1000000, 10000, "second");
+    bench_queries(reader, end_us, 60000000, 1000, "minute");
+    bench_queries(reader, end_us, 3600000000LL, 100, "hour");
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    std::string command = argv[1];
+    std::vector<const char*> files;
+    bool append = false;
+    int64_t start_us = 0, from_us = INT64_MIN, to_us = INT64_MAX;
+    bool has_start = false;
+    int days = 30;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "-a" && command == "pack") {
+            append = true;
+        } else if (arg == "-s" && has_value && command == "pack") {
+            start_us = strtoll(argv[++i], nullptr, 10);
+            has_start = true;
+        } else if (arg == "-f" && has_value && command == "query") {
+            from_us = strtoll(argv[++i], nullptr, 10);
+        } else if (arg == "-t" && has_value && command == "query") {
+            to_us = strtoll(argv[++i], nullptr, 10);
+        } else if (arg == "-d" && has_value && command == "bench") {
+            days = atoi(argv[++i]);
+        } else if (arg[0] != '-') {
+            files.push_back(argv[i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (command == "pack" && (files.size() == 1 || files.size() == 2)) {
+        return pack(files[0], files.size() == 2 ? files[1] : nullptr, append, has_start ? &start_us : nullptr);
+    }
+    if (command == "query" && files.size() == 1) return query(files[0], from_us, to_us);
+    if (command == "info" && files.size() == 1) return info(files[0]);
+    if (command == "bench" && files.size() == 1 && days > 0) return bench(files[0], days);
+    usage();
+    return 2;
+}
@@ -0,0 +1,413 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+
+// Position history archive
+// Frames (a time in microseconds and the axis values, in counts of the last digit) are stored in
+// blocks of up to BLOCK_FRAMES frames. A block keeps every column apart: the times, then each axis.
+// A column is its first value followed by the second differences of the values, as tokens:
+//   varint(zigzag(d) << 1)        one difference d that is not zero
+//   varint((n - 1) << 1 | 1)      n differences of zero
+// A machine standing still, or moving at a constant feed, costs a few bytes per block and axis.
+//
+// File: header, blocks, index, footer; all fixed size numbers little endian.
+//   header: MAGIC, VERSION, axis count, digit count, dot position, 8 reserved bytes
+//   block:  varint frame count, varint byte size of every column, the columns
+//   index:  per block: first time, last time, file offset (int64), frame count (uint32)
+//   footer: index offset (uint64), block count (uint32), MAGIC
+// The index is the only part read to find a time range, so a query maps the file and decodes
+// only the blocks that overlap the range.
+namespace archive {
+
+constexpr char MAGIC[4] = {'R', '2', 'M', 'A'};
+constexpr uint8_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 16;
+constexpr size_t ENTRY_SIZE = 28;
+constexpr size_t FOOTER_SIZE = 16;
+constexpr uint32_t BLOCK_FRAMES = 4096;  // 82 seconds at 50 frames per second
+constexpr size_t MAX_AXES = 5;
+constexpr size_t MAX_COLUMNS = MAX_AXES + 1;
+
+struct frame {
+    int64_t time_us;
+    int32_t axis[MAX_AXES];
+};
+
+// Layout of the data lines the values came from (see format.h)
+struct layout {
+    uint8_t axes;
+    uint8_t digits;
+    uint8_t dot;
+};
+
+// Index entry of a block
+struct block_info {
+    int64_t first_us;
+    int64_t last_us;
+    uint64_t offset;
+    uint32_t frames;
+};
+
+constexpr uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+constexpr int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Returns false at the end of the range or on a varint longer than 64 bits
+inline bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (p == end) return false;
+        uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+inline void put_le(uint8_t* out, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; i++) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+inline uint64_t get_le(const uint8_t* in, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++) value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    return value;
+}
+
+// One column of a block
+inline void encode_column(const std::vector<int64_t>& values, std::vector<uint8_t>& out) {
+    if (values.empty()) return;
+    put_varint(out, zigzag(values[0]));
+    int64_t delta = 0;
+    uint64_t zeros = 0;
+    for (size_t i = 1; i < values.size(); i++) {
+        int64_t next = values[i] - values[i - 1];
+        int64_t d = next - delta;
+        delta = next;
+        if (d == 0) {
+            zeros++;
+            continue;
+        }
+        if (zeros) put_varint(out, (zeros - 1) << 1 | 1);
+        zeros = 0;
+        put_varint(out, zigzag(d) << 1);
+    }
+    if (zeros) put_varint(out, (zeros - 1) << 1 | 1);
+}
+
+// Returns false if the column does not hold exactly count values
+inline bool decode_column(const uint8_t* p, const uint8_t* end, uint32_t count, int64_t* out) {
+    uint64_t token;
+    if (count == 0) return p == end;
+    if (!get_varint(p, end, token)) return false;
+    int64_t value = unzigzag(token), delta = 0;
+    out[0] = value;
+    uint32_t i = 1;
+    while (i < count) {
+        if (!get_varint(p, end, token)) return false;
+        if (token & 1) {
+            uint64_t zeros = (token >> 1) + 1;
+            if (zeros > count - i) return false;
+            for (uint64_t j = 0; j < zeros; j++) out[i++] = value += delta;
+        } else {
+            delta += unzigzag(token >> 1);
+            out[i++] = value += delta;
+        }
+    }
+    return p == end;
+}
+
+// Appends frames to an archive file; the index is written by close()
+class writer {
+   public:
+    writer() = default;
+    writer(const writer&) = delete;
+    writer& operator=(const writer&) = delete;
+    ~writer() {
+        std::string error;
+        close(error);
+    }
+
+    // New archive, an existing file is replaced
+    bool create(const char* path, layout lines, std::string& error) {
+        if (lines.axes < 1 || lines.axes > MAX_AXES) {
+            error = "axis count must be between 1 and 5";
+            return false;
+        }
+        file = fopen(path, "wb");
+        if (!file) {
+            error = std::string("cannot create ") + path;
+            return false;
+        }
+        format = lines;
+        uint8_t header[HEADER_SIZE] = {};
+        memcpy(header, MAGIC, sizeof(MAGIC));
+        header[4] = VERSION;
+        header[5] = lines.axes;
+        header[6] = lines.digits;
+        header[7] = lines.dot;
+        offset = 0;
+        total = 0;
+        index.clear();
+        return write(header, sizeof(header), error);
+    }
+
+    // Existing archive of the same layout: new blocks go where its index was, frames must be later
+    // than its last one
+    bool append(const char* path, layout lines, std::string& error);
+
+    // Frames come in time order, equal times are allowed
+    bool add(const frame& f, std::string& error) {
+        if (!file) {
+            error = "archive is not open";
+            return false;
+        }
+        if (f.time_us < last_time()) {
+            error = "frame time goes back";
+            return false;
+        }
+        columns[0].push_back(f.time_us);
+        for (size_t i = 0; i < format.axes; i++) columns[i + 1].push_back(f.axis[i]);
+        total++;
+        return count() < BLOCK_FRAMES || flush(error);
+    }
+
+    // Write the last block, the index and the footer
+    bool close(std::string& error) {
+        if (!file) return true;
+        bool ok = flush(error);
+        if (ok) {
+            std::vector<uint8_t> tail(index.size() * ENTRY_SIZE + FOOTER_SIZE);
+            uint8_t* p = tail.data();
+            for (const block_info& block : index) {
+                put_le(p, static_cast<uint64_t>(block.first_us), 8);
+                put_le(p + 8, static_cast<uint64_t>(block.last_us), 8);
+                put_le(p + 16, block.offset, 8);
+                put_le(p + 24, block.frames, 4);
+                p += ENTRY_SIZE;
+            }
+            put_le(p, offset, 8);
+            put_le(p + 8, index.size(), 4);
+            memcpy(p + 12, MAGIC, sizeof(MAGIC));
+            ok = write(tail.data(), tail.size(), error);
+        }
+        // An appended archive may have been longer than it is now
+        if (ok && (fflush(file) != 0 || ftruncate(fileno(file), static_cast<off_t>(offset)) != 0)) {
+            error = "cannot write the archive";
+            ok = false;
+        }
+        fclose(file);
+        file = nullptr;
+        return ok;
+    }
+
+    // Time of the last frame, INT64_MIN in an empty archive
+    int64_t last_time() const {
+        if (count() > 0) return columns[0].back();
+        return index.empty() ? INT64_MIN : index.back().last_us;
+    }
+
+    // Frames added since create() or append(), and bytes of the archive so far
+    uint64_t frames() const { return total; }
+    uint64_t bytes() const { return offset; }
+
+   private:
+    uint32_t count() const { return static_cast<uint32_t>(columns[0].size()); }
+
+    bool write(const void* data, size_t size, std::string& error) {
+        if (fwrite(data, 1, size, file) != size) {
+            error = "cannot write the archive";
+            return false;
+        }
+        offset += size;
+        return true;
+    }
+
+    bool flush(std::string& error) {
+        if (count() == 0) return true;
+        const size_t column_count = format.axes + 1u;
+        block.clear();
+        put_varint(block, count());
+        for (size_t i = 0; i < column_count; i++) {
+            encoded[i].clear();
+            encode_column(columns[i], encoded[i]);
+            put_varint(block, encoded[i].size());
+        }
+        for (size_t i = 0; i < column_count; i++) block.insert(block.end(), encoded[i].begin(), encoded[i].end());
+        index.push_back({columns[0].front(), columns[0].back(), offset, count()});
+        for (auto& column : columns) column.clear();
+        return write(block.data(), block.size(), error);
+    }
+
+    FILE* file = nullptr;
+    layout format = {0, 0, 0};
+    uint64_t offset = 0;
+    uint64_t total = 0;
+    std::vector<block_info> index;
+    std::vector<int64_t> columns[MAX_COLUMNS];
+    std::vector<uint8_t> encoded[MAX_COLUMNS];
+    std::vector<uint8_t> block;
+};
+
+// Memory-mapped archive
+class reader {
+   public:
+    bool open(const char* path, std::string& error) {
+        index.clear();
+        if (!file.open(path, error)) return false;
+        const uint8_t* begin = data();
+        const size_t size = file.size();
+        if (size < HEADER_SIZE + FOOTER_SIZE || memcmp(begin, MAGIC, sizeof(MAGIC)) != 0 ||
+            memcmp(begin + size - sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0) {
+            error = std::string(path) + " is not an archive";
+            return false;
+        }
+        if (begin[4] != VERSION) {
+            error = std::string(path) + ": unknown archive version " + std::to_string(begin[4]);
+            return false;
+        }
+        format = {begin[5], begin[6], begin[7]};
+        const uint8_t* footer = begin + size - FOOTER_SIZE;
+        const uint64_t index_offset = get_le(footer, 8);
+        const uint64_t blocks = get_le(footer + 8, 4);
+        if (format.axes < 1 || format.axes > MAX_AXES || index_offset < HEADER_SIZE ||
+            index_offset + blocks * ENTRY_SIZE + FOOTER_SIZE != size) {
+            error = std::string(path) + ": damaged archive";
+            return false;
+        }
+        index.resize(blocks);
+        const uint8_t* p = begin + index_offset;
+        for (block_info& block : index) {
+            block.first_us = static_cast<int64_t>(get_le(p, 8));
+            block.last_us = static_cast<int64_t>(get_le(p + 8, 8));
+            block.offset = get_le(p + 16, 8);
+            block.frames = static_cast<uint32_t>(get_le(p + 24, 4));
+            p += ENTRY_SIZE;
+            if (block.offset < HEADER_SIZE || block.offset >= index_offset || block.frames == 0 ||
+                block.frames > BLOCK_FRAMES) {
+                error = std::string(path) + ": damaged index";
+                return false;
+            }
+        }
+        end_of_blocks = index_offset;
+        return true;
+    }
+
+    layout lines() const { return format; }
+    const std::vector<block_info>& blocks() const { return index; }
+    uint64_t blocks_end() const { return end_of_blocks; }
+    uint64_t frames() const {
+        uint64_t total = 0;
+        for (const block_info& block : index) total += block.frames;
+        return total;
+    }
+
+    // Call visit(const frame&) for every frame with from_us <= time < to_us, in time order
+    // Returns false on a damaged block; decoded counts the blocks that were read
+    template <typename Visit>
+    bool query(int64_t from_us, int64_t to_us, Visit&& visit, std::string& error, size_t* decoded = nullptr) const {
+        if (decoded) *decoded = 0;
+        auto first = std::lower_bound(index.begin(), index.end(), from_us,
+                                      [](const block_info& block, int64_t time) { return block.last_us < time; });
+        std::vector<int64_t> values[MAX_COLUMNS];
+        frame f = {};
+        for (auto block = first; block != index.end() && block->first_us < to_us; ++block) {
+            const size_t next = block + 1 == index.end() ? end_of_blocks : (block + 1)->offset;
+            if (!decode(*block, next, values)) {
+                error = "damaged block at offset " + std::to_string(block->offset);
+                return false;
+            }
+            if (decoded) (*decoded)++;
+            for (uint32_t i = 0; i < block->frames; i++) {
+                f.time_us = values[0][i];
+                if (f.time_us < from_us) continue;
+                if (f.time_us >= to_us) break;
+                for (size_t j = 0; j < format.axes; j++) f.axis[j] = static_cast<int32_t>(values[j + 1][i]);
+                visit(f);
+            }
+        }
+        return true;
+    }
+
+   private:
+    const uint8_t* data() const { return reinterpret_cast<const uint8_t*>(file.begin()); }
+
+    bool decode(const block_info& block, size_t next, std::vector<int64_t> (&values)[MAX_COLUMNS]) const {
+        const uint8_t* p = data() + block.offset;
+        const uint8_t* end = data() + next;
+        uint64_t count, sizes[MAX_COLUMNS];
+        if (next <= block.offset || !get_varint(p, end, count) || count != block.frames) return false;
+        for (size_t i = 0; i <= format.axes; i++) {
+            if (!get_varint(p, end, sizes[i])) return false;
+        }
+        for (size_t i = 0; i <= format.axes; i++) {
+            if (sizes[i] > static_cast<uint64_t>(end - p)) return false;
+            values[i].resize(block.frames);
+            if (!decode_column(p, p + sizes[i], block.frames, values[i].data())) return false;
+            p += sizes[i];
+        }
+        return true;
+    }
+
+    mapped_file file;
+    layout format = {0, 0, 0};
+    std::vector<block_info> index;
+    size_t end_of_blocks = 0;
+};
+
+inline bool writer::append(const char* path, layout lines, std::string& error) {
+    reader existing;
+    if (!existing.open(path, error)) return false;
+    format = existing.lines();
+    if (format.axes != lines.axes || format.digits != lines.digits || format.dot != lines.dot) {
+        error = std::string(path) + " holds lines of another layout";
+        return false;
+    }
+    index = existing.blocks();
+    const uint64_t end = existing.blocks_end();
+    file = fopen(path, "r+b");
+    if (!file || fseeko(file, static_cast<off_t>(end), SEEK_SET) != 0) {
+        error = std::string("cannot write ") + path;
+        return false;
+    }
+    offset = end;
+    total = 0;
+    return true;
+}
+
+}  // namespace archive
@@ -0,0 +1,167 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// Offline decoder for logic analyzer captures of the Razmer 2M bus
+// Applies the transmitter decoding rules to a VCD or sigrok CSV capture and writes
+// the same line stream the transmitter would send, followed by timing statistics.
+//
+// Usage: razmer2m_bus_decode [options] capture.vcd|capture.csv
+//   -f vcd|csv         capture format (default: from the file extension)
+//   -m CHANNEL=LINE    map a capture channel to a bus line (W1..W8, ER, A7, B0..B5), repeatable
+//   -r HZ              sample rate of a CSV capture without a time column
+//   -o FILE            write the lines to FILE instead of stdout
+//   -q                 do not print statistics
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "bus.h"
+#include "capture.h"
+#include "format.h"
+#include "mapped_file.h"
+
+namespace {
+
+void usage() {
+    fputs(
+        "usage: razmer2m_bus_decode [-f vcd|csv] [-m CHANNEL=LINE]... [-r HZ] [-o FILE] [-q] capture\n"
+        "lines: W1 W2 W4 W8 ER A7 B0 B1 B2 B3 B4 B5\n",
+        stderr);
+}
+
+bool ends_with(const std::string& text, const char* suffix) {
+    size_t n = strlen(suffix);
+    return text.size() >= n && capture::iequals(std::string_view(text).substr(text.size() - n), suffix);
+}
+
+void print_stat(const char* name, const capture::stat& s) {
+    if (s.count == 0) {
+        fprintf(stderr, "  %-8s -\n", name);
+        return;
+    }
+    fprintf(stderr, "  %-8s min %10.3f  mean %10.3f  max %10.3f us  (%llu)\n", name, s.min / 1e6, s.mean() / 1e6,
+            s.max / 1e6, static_cast<unsigned long long>(s.count));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    capture::channel_map map;
+    std::string input, output, type;
+    double sample_rate = 0;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "-f" && has_value) {
+            type = argv[++i];
+        } else if (arg == "-m" && has_value) {
+            if (!map.add(argv[++i])) {
+                fprintf(stderr, "invalid mapping: %s\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "-r" && has_value) {
+            sample_rate = atof(argv[++i]);
+        } else if (arg == "-o" && has_value) {
+            output = argv[++i];
+        } else if (arg == "-q") {
+            quiet = true;
+        } else if (arg[0] != '-' && input.empty()) {
+            input = arg;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (input.empty()) {
+        usage();
+        return 2;
+    }
+    if (type.empty()) type = ends_with(input, ".csv") ? "csv" : "vcd";
+
+    std::string error;
+    mapped_file file;
+    if (!file.open(input.c_str(), error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    FILE* out = output.empty() ? stdout : fopen(output.c_str(), "w");
+    if (!out) {
+        fprintf(stderr, "cannot create %s\n", output.c_str());
+        return 1;
+    }
+    static char out_buffer[1 << 20];
+    setvbuf(out, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    // The decoder counters are 16 bit like on the transmitter, keep wide totals here
+    bus::decoder<> decoder;
+    capture::timing timing;
+    capture::stat frame_period;
+    uint64_t events = 0, frames = 0, invalid = 0, glitches = 0;
+    uint16_t last_glitches = 0;
+    int64_t last_frame = -1, last_time = 0;
+    char line[AXIS_COUNT * 10 + 1];
+
+    auto sink = [&](const capture::event& e) {
+        events++;
+        last_time = e.time_ps;
+        timing.add(e);
+        bool complete = decoder.sample(e.pind, e.pinc);
+        glitches += static_cast<uint16_t>(decoder.glitches() - last_glitches);
+        last_glitches = decoder.glitches();
+        if (!complete) return;
+
+        frames++;
+        if (last_frame >= 0) frame_period.add(e.time_ps - last_frame);
+        last_frame = e.time_ps;
+
+        int64_t axis[AXIS_COUNT];
+        if (!bus::decode(decoder.last(), axis)) {
+            invalid++;
+            return;
+        }
+        fputs(format(axis, line), out);
+    };
+
+    bool ok = type == "csv" ? capture::parse_csv(file.begin(), file.end(), map, sample_rate > 0 ? 1.0 / sample_rate : 0,
+                                                 sink, error)
+                            : capture::parse_vcd(file.begin(), file.end(), map, sink, error);
+    fflush(out);
+    if (out != stdout) fclose(out);
+    if (!ok) {
+        fprintf(stderr, "%s: %s\n", input.c_str(), error.c_str());
+        return 1;
+    }
+
+    if (!quiet) {
+        fprintf(stderr, "%s: %.6f s, %llu events\n", input.c_str(), last_time / 1e12,
+                static_cast<unsigned long long>(events));
+        fprintf(stderr, "  frames   %llu (%llu with invalid codes)\n", static_cast<unsigned long long>(frames),
+                static_cast<unsigned long long>(invalid));
+        fprintf(stderr, "  glitches %llu\n", static_cast<unsigned long long>(glitches));
+        print_stat("frame", frame_period);
+        print_stat("strobe", timing.period);
+        print_stat("width", timing.width);
+        print_stat("setup", timing.setup);
+        print_stat("hold", timing.hold);
+    }
+    return 0;
+}
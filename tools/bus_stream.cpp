@@ -0,0 +1,148 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// Waveform reconstruction from the transmitter raw bus stream (see raw.h and sampler.h)
+// Writes the bus lines as a VCD file, which GTKWave shows and razmer2m_bus_decode decodes,
+// followed by stream statistics.
+//
+// Usage: razmer2m_bus_stream [options] stream.bin
+//   -p NS      sample period in nanoseconds, for a stream captured without its "#r" header
+//   -o FILE    write the VCD to FILE instead of stdout
+//   -q         do not print statistics
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "capture.h"
+#include "mapped_file.h"
+#include "raw.h"
+#include "stamp.h"
+
+namespace {
+
+void usage() { fputs("usage: razmer2m_bus_stream [-p NS] [-o FILE] [-q] stream\n", stderr); }
+
+// Sample period from the "#r<hex>" header line at the start of the stream
+// Returns the position after the header, or begin if there is none
+const char* parse_header(const char* begin, const char* end, uint32_t& period_ns) {
+    if (end - begin < static_cast<ptrdiff_t>(stamp::LINE_SIZE)) return begin;
+    if (begin[0] != stamp::PREFIX || begin[1] != raw::TAG || begin[stamp::LINE_SIZE - 1] != '\n') return begin;
+    uint32_t value = 0;
+    for (const char* p = begin + 2; p < begin + stamp::LINE_SIZE - 1; p++) {
+        char c = *p;
+        if (c >= '0' && c <= '9') {
+            value = (value << 4) | static_cast<uint32_t>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            value = (value << 4) | static_cast<uint32_t>(c - 'a' + 10);
+        } else {
+            return begin;
+        }
+    }
+    period_ns = value;
+    return begin + stamp::LINE_SIZE;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string input, output;
+    uint32_t period_ns = 0;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "-p" && has_value) {
+            period_ns = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "-o" && has_value) {
+            output = argv[++i];
+        } else if (arg == "-q") {
+            quiet = true;
+        } else if (arg[0] != '-' && input.empty()) {
+            input = arg;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (input.empty()) {
+        usage();
+        return 2;
+    }
+
+    std::string error;
+    mapped_file file;
+    if (!file.open(input.c_str(), error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    // The command line wins over the header
+    uint32_t header_ns = 0;
+    const char* begin = parse_header(file.begin(), file.end(), header_ns);
+    if (period_ns == 0) period_ns = header_ns;
+    if (period_ns == 0) {
+        fprintf(stderr, "%s: no \"#r\" header, give the sample period with -p\n", input.c_str());
+        return 1;
+    }
+
+    FILE* out = output.empty() ? stdout : fopen(output.c_str(), "w");
+    if (!out) {
+        fprintf(stderr, "cannot create %s\n", output.c_str());
+        return 1;
+    }
+    static char out_buffer[1 << 20];
+    setvbuf(out, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    // Every run becomes an event at the time of its first sample; dropped samples keep the
+    // last known state, so the time line stays right
+    capture::vcd_writer vcd(out);
+    raw::decoder decoder;
+    uint64_t samples = 0, runs = 0, dropped = 0, drops = 0, longest_drop = 0;
+    for (const char* p = begin; p < file.end(); p++) {
+        switch (decoder.feed(static_cast<uint8_t>(*p))) {
+            case raw::decoder::RUN:
+                vcd.write({static_cast<int64_t>(samples * period_ns * 1000), decoder.pind(), decoder.pinc()});
+                samples += decoder.samples();
+                runs++;
+                break;
+            case raw::decoder::DROPPED:
+                samples += decoder.samples();
+                dropped += decoder.samples();
+                drops++;
+                if (decoder.samples() > longest_drop) longest_drop = decoder.samples();
+                break;
+            default:
+                break;
+        }
+    }
+    fprintf(out, "#%llu\n", static_cast<unsigned long long>(samples * period_ns));
+    fflush(out);
+    if (out != stdout) fclose(out);
+
+    if (!quiet) {
+        fprintf(stderr, "%s: %.6f s, %llu samples of %u ns, %llu runs\n", input.c_str(), samples * period_ns / 1e9,
+                static_cast<unsigned long long>(samples), period_ns, static_cast<unsigned long long>(runs));
+        fprintf(stderr, "  dropped  %llu samples (%.3f %%) in %llu gaps, longest %.3f us\n",
+                static_cast<unsigned long long>(dropped), samples ? 100.0 * dropped / samples : 0.0,
+                static_cast<unsigned long long>(drops), longest_drop * period_ns / 1e3);
+        fprintf(stderr, "  skipped  %llu bytes\n", static_cast<unsigned long long>(decoder.skipped()));
+    }
+    return 0;
+}
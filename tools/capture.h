@@ -0,0 +1,465 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "bus.h"
+
+// Logic analyzer captures of the Razmer 2M bus
+// The parsers work on a memory range (usually a mapped file) in a single forward pass
+// and report every change of the bus lines as port images, the same way the transmitter sees them.
+namespace capture {
+
+// State of all bus lines from `time` on
+struct event {
+    int64_t time_ps;  // Picoseconds from the start of the capture
+    uint8_t pind;     // W1..W8, ER, A7 as on PIND
+    uint8_t pinc;     // B0..B5 as on PINC
+};
+
+// Bus lines and their position in the port images
+struct line_t {
+    const char* name;
+    bool port_c;
+    uint8_t mask;
+};
+
+constexpr line_t LINES[] = {
+    {"W1", false, 1 << 2}, {"W2", false, 1 << 3}, {"W4", false, 1 << 4}, {"W8", false, 1 << 5},
+    {"ER", false, 1 << 6}, {"A7", false, 1 << 7}, {"B0", true, 1 << 0},  {"B1", true, 1 << 1},
+    {"B2", true, 1 << 2},  {"B3", true, 1 << 3},  {"B4", true, 1 << 4},  {"B5", true, 1 << 5},
+};
+constexpr int LINE_COUNT = sizeof(LINES) / sizeof(LINES[0]);
+
+inline bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        char x = a[i], y = b[i];
+        if (x >= 'a' && x <= 'z') x = static_cast<char>(x - 'a' + 'A');
+        if (y >= 'a' && y <= 'z') y = static_cast<char>(y - 'a' + 'A');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+// Index in LINES of a line name, -1 if unknown
+inline int find_line(std::string_view name) {
+    for (int i = 0; i < LINE_COUNT; i++) {
+        if (iequals(name, LINES[i].name)) return i;
+    }
+    return -1;
+}
+
+// Maps capture channel names to bus lines
+// Channels named like the lines (W1, B0, ...) are mapped automatically,
+// others (D0, "channel 3", ...) need an explicit alias.
+class channel_map {
+   public:
+    // Add an alias "CHANNEL=LINE", returns false on a malformed alias or unknown line
+    bool add(std::string_view alias) {
+        size_t eq = alias.find('=');
+        if (eq == std::string_view::npos) return false;
+        int line = find_line(alias.substr(eq + 1));
+        if (line < 0) return false;
+        aliases.emplace_back(std::string(alias.substr(0, eq)), line);
+        return true;
+    }
+
+    // Line index for a channel name, -1 if the channel is not a bus line
+    int resolve(std::string_view channel) const {
+        for (auto& alias : aliases) {
+            if (alias.first == channel) return alias.second;
+        }
+        return find_line(channel);
+    }
+
+   private:
+    std::vector<std::pair<std::string, int>> aliases;
+};
+
+namespace detail {
+
+// Current line levels, emits an event whenever they changed
+template <typename Sink>
+class state {
+   public:
+    explicit state(Sink& sink) : sink(sink) {}
+
+    void set(int line, bool level) {
+        uint8_t& port = LINES[line].port_c ? pinc : pind;
+        if (level) {
+            port = static_cast<uint8_t>(port | LINES[line].mask);
+        } else {
+            port = static_cast<uint8_t>(port & ~LINES[line].mask);
+        }
+    }
+
+    // All changes up to `time` have been applied
+    // The lines start low with an idle address, like the decoder expects them
+    void flush(int64_t time_ps) {
+        if (pind == last_pind && pinc == last_pinc) return;
+        sink(event{time_ps, pind, pinc});
+        last_pind = pind;
+        last_pinc = pinc;
+    }
+
+   private:
+    Sink& sink;
+    uint8_t pind = 0;
+    uint8_t pinc = bus::IDLE;
+    uint8_t last_pind = 0;
+    uint8_t last_pinc = bus::IDLE;
+};
+
+inline const char* skip_spaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    return p;
+}
+
+inline const char* token_end(const char* p, const char* end) {
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+    return p;
+}
+
+inline const char* line_end(const char* p, const char* end) {
+    auto nl = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+    return nl ? nl : end;
+}
+
+// Picoseconds per unit of a VCD timescale such as "10 ns" or "1us", 0 if invalid
+inline int64_t parse_timescale(std::string_view text) {
+    size_t i = 0;
+    while (i < text.size() && (text[i] == ' ' || text[i] == '\t' || text[i] == '\n' || text[i] == '\r')) i++;
+    int64_t number = 0;
+    while (i < text.size() && text[i] >= '0' && text[i] <= '9') number = number * 10 + (text[i++] - '0');
+    while (i < text.size() && (text[i] == ' ' || text[i] == '\t' || text[i] == '\n' || text[i] == '\r')) i++;
+    std::string_view unit = text.substr(i, 2);
+    if (number == 0 || unit.empty()) return 0;
+    if (unit[0] == 's') return number * 1000000000000LL;
+    if (unit == "ms") return number * 1000000000LL;
+    if (unit == "us") return number * 1000000LL;
+    if (unit == "ns") return number * 1000LL;
+    if (unit == "ps") return number;
+    if (unit == "fs") return number >= 1000 ? number / 1000 : 1;
+    return 0;
+}
+
+}  // namespace detail
+
+// Parse a Value Change Dump
+// Scalar wires whose names resolve through the map are tracked, everything else is ignored.
+// Calls sink(event) for every change of the bus lines. Returns false and sets error on malformed input.
+template <typename Sink>
+bool parse_vcd(const char* begin, const char* end, const channel_map& map, Sink&& sink, std::string& error) {
+    detail::state<Sink> lines(sink);
+    int64_t scale_ps = 1000;  // VCD default is 1 ns
+
+    // Identifier codes are usually a single printable character, keep a direct table for those
+    int16_t short_ids[128];
+    for (auto& id : short_ids) id = -1;
+    std::unordered_map<std::string, int> long_ids;
+    int mapped = 0;
+
+    // Header
+    const char* p = begin;
+    while (true) {
+        p = detail::skip_spaces(p, end);
+        if (p >= end) {
+            error = "missing $enddefinitions";
+            return false;
+        }
+        const char* keyword_end = detail::token_end(p, end);
+        std::string_view keyword(p, static_cast<size_t>(keyword_end - p));
+        auto found = std::string_view(keyword_end, static_cast<size_t>(end - keyword_end)).find("$end");
+        if (found == std::string_view::npos) {
+            error = "unterminated " + std::string(keyword);
+            return false;
+        }
+        std::string_view body(keyword_end, found);
+        p = keyword_end + found + 4;
+
+        if (keyword == "$enddefinitions") break;
+        if (keyword == "$timescale") {
+            scale_ps = detail::parse_timescale(body);
+            if (scale_ps == 0) {
+                error = "unsupported timescale";
+                return false;
+            }
+        } else if (keyword == "$var") {
+            // $var wire 1 ! W1 $end
+            std::vector<std::string_view> fields;
+            const char* f = body.data();
+            const char* f_end = body.data() + body.size();
+            while ((f = detail::skip_spaces(f, f_end)) < f_end) {
+                const char* e = detail::token_end(f, f_end);
+                fields.emplace_back(f, static_cast<size_t>(e - f));
+                f = e;
+            }
+            if (fields.size() < 4) {
+                error = "malformed $var";
+                return false;
+            }
+            if (fields[1] != "1") continue;
+            int line = map.resolve(fields[3]);
+            if (line < 0) continue;
+            std::string_view id = fields[2];
+            if (id.size() == 1 && static_cast<uint8_t>(id[0]) < 128) {
+                short_ids[static_cast<uint8_t>(id[0])] = static_cast<int16_t>(line);
+            } else {
+                long_ids[std::string(id)] = line;
+            }
+            mapped++;
+        }
+    }
+    if (mapped == 0) {
+        error = "no bus lines found, use --map CHANNEL=LINE";
+        return false;
+    }
+
+    // Value changes
+    int64_t time = 0;
+    while (p < end) {
+        // Fast path for the bulk of a dump: "0!\n" or "1!\n" with a single character identifier
+        if (end - p >= 3 && p[2] == '\n' && (p[0] == '0' || p[0] == '1') && static_cast<uint8_t>(p[1]) < 128) {
+            int line = short_ids[static_cast<uint8_t>(p[1])];
+            if (line >= 0) lines.set(line, p[0] == '1');
+            p += 3;
+            continue;
+        }
+
+        const char* eol = detail::line_end(p, end);
+        const char* q = p;
+        p = eol + 1;
+        while (q < eol && (*q == ' ' || *q == '\t')) q++;
+        if (q >= eol || *q == '\r') continue;
+
+        char c = *q;
+        if (c == '#') {
+            int64_t t = 0;
+            for (q++; q < eol && *q >= '0' && *q <= '9'; q++) t = t * 10 + (*q - '0');
+            lines.flush(time);
+            time = t * scale_ps;
+            continue;
+        }
+
+        bool level;
+        if (c == '0' || c == '1' || c == 'x' || c == 'X' || c == 'z' || c == 'Z') {
+            level = c == '1';
+            q++;
+        } else if (c == 'b' || c == 'B') {
+            // Single bit vector: b1 !
+            const char* bits_end = detail::token_end(q, eol);
+            level = bits_end[-1] == '1';
+            q = detail::skip_spaces(bits_end, eol);
+        } else {
+            // $dumpvars, $end, $comment, real values, ...
+            continue;
+        }
+
+        const char* id_end = detail::token_end(q, eol);
+        int line = -1;
+        if (id_end - q == 1 && static_cast<uint8_t>(*q) < 128) {
+            line = short_ids[static_cast<uint8_t>(*q)];
+        } else if (!long_ids.empty()) {
+            auto it = long_ids.find(std::string(q, static_cast<size_t>(id_end - q)));
+            if (it != long_ids.end()) line = it->second;
+        }
+        if (line >= 0) lines.set(line, level);
+    }
+    lines.flush(time);
+    return true;
+}
+
+// Parse a sigrok-style CSV export
+// Lines starting with ';' or '#' are comments. The first other line holds the column names;
+// a column whose name starts with "time" is the time in seconds, otherwise rows are
+// sample_period_s apart. Calls sink(event) for every change of the bus lines.
+template <typename Sink>
+bool parse_csv(const char* begin, const char* end, const channel_map& map, double sample_period_s, Sink&& sink,
+               std::string& error) {
+    detail::state<Sink> lines(sink);
+    std::vector<int> columns;
+    int time_column = -1;
+    int mapped = 0;
+    int64_t row = 0;
+
+    const char* p = begin;
+    while (p < end) {
+        const char* eol = detail::line_end(p, end);
+        const char* q = p;
+        p = eol + 1;
+        const char* content_end = eol;
+        if (content_end > q && content_end[-1] == '\r') content_end--;
+        if (q >= content_end || *q == ';' || *q == '#') continue;
+
+        if (columns.empty()) {
+            // Header
+            while (true) {
+                const char* comma = static_cast<const char*>(memchr(q, ',', static_cast<size_t>(content_end - q)));
+                const char* field_end = comma ? comma : content_end;
+                std::string_view name(q, static_cast<size_t>(field_end - q));
+                while (!name.empty() && (name.front() == ' ' || name.front() == '"')) name.remove_prefix(1);
+                while (!name.empty() && (name.back() == ' ' || name.back() == '"')) name.remove_suffix(1);
+                int line = map.resolve(name);
+                if (line < 0 && name.size() >= 4 && iequals(name.substr(0, 4), "time")) {
+                    time_column = static_cast<int>(columns.size());
+                }
+                if (line >= 0) mapped++;
+                columns.push_back(line);
+                if (!comma) break;
+                q = comma + 1;
+            }
+            if (mapped == 0) {
+                error = "no bus lines found, use --map CHANNEL=LINE";
+                return false;
+            }
+            if (time_column < 0 && !(sample_period_s > 0)) {
+                error = "no time column, use --samplerate";
+                return false;
+            }
+            continue;
+        }
+
+        // Data row
+        int64_t time = static_cast<int64_t>(static_cast<double>(row) * sample_period_s * 1e12 + 0.5);
+        for (size_t column = 0; column < columns.size() && q <= content_end; column++) {
+            const char* comma = static_cast<const char*>(memchr(q, ',', static_cast<size_t>(content_end - q)));
+            const char* field_end = comma ? comma : content_end;
+            if (static_cast<int>(column) == time_column) {
+                time = static_cast<int64_t>(strtod(std::string(q, static_cast<size_t>(field_end - q)).c_str(), nullptr) *
+                                                1e12 +
+                                            0.5);
+            } else if (columns[column] >= 0) {
+                const char* v = q;
+                while (v < field_end && *v == ' ') v++;
+                lines.set(columns[column], v < field_end && *v == '1');
+            }
+            if (!comma) break;
+            q = comma + 1;
+        }
+        lines.flush(time);
+        row++;
+    }
+    if (columns.empty()) {
+        error = "empty capture";
+        return false;
+    }
+    return true;
+}
+
+// Running minimum, maximum and mean of a duration
+struct stat {
+    int64_t min = 0;
+    int64_t max = 0;
+    int64_t sum = 0;
+    uint64_t count = 0;
+
+    void add(int64_t value) {
+        if (count == 0 || value < min) min = value;
+        if (count == 0 || value > max) max = value;
+        sum += value;
+        count++;
+    }
+
+    int64_t mean() const { return count ? sum / static_cast<int64_t>(count) : 0; }
+};
+
+// Bus timing measured on the events of a capture
+//   - period: strobe start to strobe start
+//   - width: strobe duration
+//   - setup: last code change to strobe start
+//   - hold: strobe end to the next code change
+class timing {
+   public:
+    stat period;
+    stat width;
+    stat setup;
+    stat hold;
+
+    void add(const event& e) {
+        uint8_t code = bus::code_of(e.pind);
+        uint8_t addr = bus::address_of(e.pinc);
+
+        if (code != last_code) {
+            if (strobe_end >= 0) hold.add(e.time_ps - strobe_end);
+            strobe_end = -1;
+            code_change = e.time_ps;
+            last_code = code;
+        }
+        if (addr != last_addr) {
+            if (last_addr == bus::IDLE) {
+                setup.add(e.time_ps - code_change);
+                if (strobe_start >= 0) period.add(e.time_ps - strobe_start);
+                strobe_start = e.time_ps;
+                strobe_end = -1;
+            } else if (addr == bus::IDLE) {
+                width.add(e.time_ps - strobe_start);
+                strobe_end = e.time_ps;
+            }
+            last_addr = addr;
+        }
+    }
+
+   private:
+    int64_t code_change = 0;
+    int64_t strobe_start = -1;
+    int64_t strobe_end = -1;
+    uint8_t last_code = 0;
+    uint8_t last_addr = bus::IDLE;
+};
+
+// Writes bus events as a Value Change Dump with 1 ns resolution, readable by parse_vcd() and GTKWave
+class vcd_writer {
+   public:
+    explicit vcd_writer(FILE* file) : file(file) {
+        fputs("$timescale 1ns $end\n$scope module razmer2m $end\n", file);
+        for (int i = 0; i < LINE_COUNT; i++) fprintf(file, "$var wire 1 %c %s $end\n", id(i), LINES[i].name);
+        fputs("$upscope $end\n$enddefinitions $end\n", file);
+    }
+
+    void write(const event& e) {
+        if (e.pind == pind && e.pinc == pinc && started) return;
+        fprintf(file, "#%lld\n", static_cast<long long>(e.time_ps / 1000));
+        for (int i = 0; i < LINE_COUNT; i++) {
+            uint8_t now = LINES[i].port_c ? e.pinc : e.pind;
+            uint8_t before = LINES[i].port_c ? pinc : pind;
+            if (started && ((now ^ before) & LINES[i].mask) == 0) continue;
+            fprintf(file, "%c%c\n", (now & LINES[i].mask) ? '1' : '0', id(i));
+        }
+        pind = e.pind;
+        pinc = e.pinc;
+        started = true;
+    }
+
+   private:
+    static char id(int line) { return static_cast<char>('!' + line); }
+
+    FILE* file;
+    uint8_t pind = 0;
+    uint8_t pinc = 0;
+    bool started = false;
+};
+
+}  // namespace capture
@@ -0,0 +1,371 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FAST_PARSE_X86 1
+
+// Aligned loads of the tables, as macros: helper functions would need the target attribute of every caller
+#define FAST_PARSE_LOAD128(p) _mm_load_si128(reinterpret_cast<const __m128i*>(p))
+#define FAST_PARSE_LOAD256(p) _mm256_load_si256(reinterpret_cast<const __m256i*>(p))
+#endif
+
+// Host parser of data lines, for bulk consumers of the link output (loggers, archives, replay)
+// Unlike parse() (see parse.h), which takes any spacing, it accepts exactly the fixed width layout
+// format<N, D, P>() writes: per field 7 - D spaces, ' ' or '-', the digits with the dot at P,
+// and ':' or, after the last field, '\n'. That makes every byte position of a line known in
+// advance, so a whole line is checked and converted with a few vector operations:
+//   - every byte is compared against its class (space, sign, digit, dot, separator) at once;
+//   - the digits of every field are moved to an 8 byte slot, right aligned and without the dot,
+//     and all slots are converted together: pairs of digits, then quads, then whole values.
+// The SSE2 and AVX2 versions are chosen at run time; the scalar version is the reference they
+// are tested against and the fallback on other hosts.
+namespace fast_parse {
+
+enum class isa : uint8_t { SCALAR, SSE2, AVX2 };
+
+inline const char* name(isa which) {
+    switch (which) {
+        case isa::SSE2:
+            return "sse2";
+        case isa::AVX2:
+            return "avx2";
+        default:
+            return "scalar";
+    }
+}
+
+// Best instruction set of this CPU
+inline isa detect() {
+#ifdef FAST_PARSE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return isa::AVX2;
+    if (__builtin_cpu_supports("sse2")) return isa::SSE2;
+#endif
+    return isa::SCALAR;
+}
+
+// Bytes every line parser may read from the start of a line, the buffer parser takes care of it
+constexpr size_t WINDOW = 64;
+
+struct stats {
+    uint64_t frames;  // Data lines
+    uint64_t other;   // Other lines: time stamps, status lines, damaged lines
+};
+
+template <size_t N, int D, int P>
+class parser {
+    static_assert(N >= 1 && N <= 5, "1 to 5 axes");
+    static_assert(D >= 1 && D <= 7 && P >= 0 && P <= D, "1 to 7 digits, the dot within them");
+
+   public:
+    static constexpr bool HAS_DOT = P < D;
+    static constexpr size_t FIELD = HAS_DOT ? 10 : 9;  // Sign field and digits (8), the dot, the separator
+    static constexpr size_t LINE = N * FIELD;           // With the newline
+
+    explicit parser(isa which = detect()) : which(which) {}
+
+    isa instruction_set() const { return which; }
+
+    // Parse the data lines of a buffer, calling visit(const int32_t (&axis)[N]) for each of them
+    template <typename Visit>
+    stats parse(const char* begin, const char* end, Visit&& visit) const {
+        switch (which) {
+#ifdef FAST_PARSE_X86
+            case isa::AVX2:
+                return run<line_avx2, find_avx2>(begin, end, visit);
+            case isa::SSE2:
+                return run<line_sse2, find_sse2>(begin, end, visit);
+#endif
+            default:
+                return run<line_scalar, find_scalar>(begin, end, visit);
+        }
+    }
+
+    // One line at p, WINDOW bytes must be readable; returns false if it is not a data line
+    bool line(const char* p, int32_t (&axis)[N]) const {
+        switch (which) {
+#ifdef FAST_PARSE_X86
+            case isa::AVX2:
+                return line_avx2(p, axis);
+            case isa::SSE2:
+                return line_sse2(p, axis);
+#endif
+            default:
+                return line_scalar(p, axis);
+        }
+    }
+
+    // Reference: the layout spelled out one byte after the other
+    static bool line_scalar(const char* p, int32_t (&axis)[N]) {
+        for (size_t f = 0; f < N; f++) {
+            const char* q = p + f * FIELD;
+            for (int i = 0; i < 7 - D; i++) {
+                if (*q++ != ' ') return false;
+            }
+            const char sign = *q++;
+            if (sign != ' ' && sign != '-') return false;
+            int32_t value = 0;
+            for (int i = 0; i < D; i++) {
+                if (HAS_DOT && i == P && *q++ != '.') return false;
+                const char c = *q++;
+                if (c < '0' || c > '9') return false;
+                value = value * 10 + (c - '0');
+            }
+            if (*q != (f + 1 < N ? ':' : '\n')) return false;
+            axis[f] = sign == '-' ? -value : value;
+        }
+        return true;
+    }
+
+   private:
+    // Byte classes of every position of a line, zero after its end, and the masks that move the
+    // digits of a field, from its sign on, to the low 8 bytes: right aligned, without the dot
+    struct tables_t {
+        alignas(32) uint8_t digit[WINDOW];  // 0xFF on digits
+        alignas(32) uint8_t sign[WINDOW];   // 0xFF on the sign of a field
+        alignas(32) uint8_t fixed[WINDOW];  // 0xFF on spaces, the dot and separators
+        alignas(32) char expected[WINDOW];  // Their character
+        alignas(16) uint8_t whole[16];      // SSE2: 0xFF on the digits before the dot
+        alignas(16) uint8_t fraction[16];   // and after it
+        alignas(32) uint8_t gather_a[32];   // AVX2: pshufb to the low half of both lanes
+        alignas(32) uint8_t gather_b[32];   // to the high half
+        alignas(32) uint8_t sign_a[32];     // The sign to the first 32 bit word of both lanes
+        alignas(32) uint8_t sign_b[32];     // to the second
+        uint8_t sign_at[N];                 // Position of the sign of every field
+    };
+
+    static constexpr tables_t make_tables() {
+        tables_t t = {};
+        for (size_t f = 0; f < N; f++) {
+            size_t at = f * FIELD;
+            for (int i = 0; i < 7 - D; i++, at++) {
+                t.fixed[at] = 0xFF;
+                t.expected[at] = ' ';
+            }
+            t.sign[at] = 0xFF;
+            t.sign_at[f] = static_cast<uint8_t>(at++);
+            for (int i = 0; i < D; i++, at++) {
+                if (HAS_DOT && i == P) {
+                    t.fixed[at] = 0xFF;
+                    t.expected[at++] = '.';
+                }
+                t.digit[at] = 0xFF;
+            }
+            t.fixed[at] = 0xFF;
+            t.expected[at] = f + 1 < N ? ':' : '\n';
+        }
+        for (int i = 0; i < D; i++) (i < P ? t.whole : t.fraction)[1 + i + (HAS_DOT && i >= P)] = 0xFF;
+        for (size_t i = 0; i < 32; i++) {
+            const size_t j = i % 8, half = i % 16 / 8;
+            size_t from = 0x80;  // Cleared
+            if (j >= 8 - D) {
+                const size_t digit = j - (8 - D);
+                from = 1 + digit + (HAS_DOT && digit >= P);
+            }
+            t.gather_a[i] = static_cast<uint8_t>(half == 0 ? from : 0x80);
+            t.gather_b[i] = static_cast<uint8_t>(half == 1 ? from : 0x80);
+            t.sign_a[i] = static_cast<uint8_t>(i % 16 == 0 ? 0 : 0x80);
+            t.sign_b[i] = static_cast<uint8_t>(i % 16 == 4 ? 0 : 0x80);
+        }
+        return t;
+    }
+
+    static constexpr tables_t tables = make_tables();
+
+#ifdef FAST_PARSE_X86
+    // The line is checked 16 bytes at a time, every byte against its class. The digits of every
+    // field are then moved with byte shifts to an 8 byte slot, two fields per register, and
+    // converted with pmaddwd: to pairs, to quads, and after a pack to the value of every slot.
+    __attribute__((target("sse2"))) static bool line_sse2(const char* p, int32_t (&axis)[N]) {
+        constexpr size_t CHUNKS = (LINE + 15) / 16;
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ascii_zero = _mm_set1_epi8('0');
+        const __m128i nine = _mm_set1_epi8(9);
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i minus = _mm_set1_epi8('-');
+        for (size_t c = 0; c < CHUNKS; c++) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + c * 16));
+            const __m128i is_digit = _mm_cmpeq_epi8(_mm_subs_epu8(_mm_sub_epi8(x, ascii_zero), nine), zero);
+            const __m128i is_sign = _mm_or_si128(_mm_cmpeq_epi8(x, space), _mm_cmpeq_epi8(x, minus));
+            const __m128i is_fixed = _mm_cmpeq_epi8(x, FAST_PARSE_LOAD128(tables.expected + c * 16));
+            __m128i ok = _mm_and_si128(is_digit, FAST_PARSE_LOAD128(tables.digit + c * 16));
+            ok = _mm_or_si128(ok, _mm_and_si128(is_sign, FAST_PARSE_LOAD128(tables.sign + c * 16)));
+            ok = _mm_or_si128(ok, _mm_and_si128(is_fixed, FAST_PARSE_LOAD128(tables.fixed + c * 16)));
+            if (static_cast<uint32_t>(_mm_movemask_epi8(ok)) != chunk_mask(c)) return false;
+        }
+
+        // Fields 4g and 4g + 1 share the first register, 4g + 2 and 4g + 3 the second
+        constexpr size_t GROUPS = (N + 3) / 4;
+        int32_t value[GROUPS * 4];
+        for (size_t g = 0; g < GROUPS; g++) {
+            __m128i quads[2];
+            for (size_t r = 0; r < 2; r++) {
+                const __m128i a = slot_sse2(field(p, g * 4 + r * 2));
+                const __m128i b = _mm_slli_si128(slot_sse2(field(p, g * 4 + r * 2 + 1)), 8);
+                const __m128i digits = _mm_subs_epu8(_mm_or_si128(a, b), ascii_zero);
+                const __m128i low = _mm_madd_epi16(_mm_unpacklo_epi8(digits, zero), _mm_set1_epi32(0x0001000A));
+                const __m128i high = _mm_madd_epi16(_mm_unpackhi_epi8(digits, zero), _mm_set1_epi32(0x0001000A));
+                quads[r] = _mm_madd_epi16(_mm_packs_epi32(low, high), _mm_set1_epi32(0x00010064));
+            }
+            const __m128i v = _mm_madd_epi16(_mm_packs_epi32(quads[0], quads[1]), _mm_set1_epi32(0x00012710));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(value + g * 4), v);
+        }
+
+        // The sign is applied without a branch: it is as good as random on real data
+        for (size_t f = 0; f < N; f++) {
+            const int32_t negative = -static_cast<int32_t>(p[tables.sign_at[f]] == '-');
+            axis[f] = (value[f] ^ negative) - negative;
+        }
+        return true;
+    }
+
+    // The digits of a field in the low 8 bytes, the rest cleared
+    __attribute__((target("sse2"))) static __m128i slot_sse2(const __m128i* at) {
+        const __m128i x = _mm_loadu_si128(at);
+        const __m128i whole = _mm_slli_si128(_mm_and_si128(x, FAST_PARSE_LOAD128(tables.whole)), 7 - D);
+        if constexpr (!HAS_DOT) {
+            return whole;
+        } else {
+            const __m128i fraction = _mm_and_si128(x, FAST_PARSE_LOAD128(tables.fraction));
+            if constexpr (D == 7) return _mm_or_si128(whole, _mm_srli_si128(fraction, 1));
+            else return _mm_or_si128(whole, _mm_slli_si128(fraction, 6 - D));
+        }
+    }
+
+    // As line_sse2, 32 bytes at a time; the digits are gathered into the slots with pshufb, four
+    // fields per register, and pmaddubsw makes the pairs
+    __attribute__((target("avx2"))) static bool line_avx2(const char* p, int32_t (&axis)[N]) {
+        constexpr size_t CHUNKS = (LINE + 31) / 32;
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i ascii_zero = _mm256_set1_epi8('0');
+        const __m256i nine = _mm256_set1_epi8(9);
+        const __m256i space = _mm256_set1_epi8(' ');
+        const __m256i minus = _mm256_set1_epi8('-');
+        for (size_t c = 0; c < CHUNKS; c++) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + c * 32));
+            const __m256i is_digit =
+                _mm256_cmpeq_epi8(_mm256_subs_epu8(_mm256_sub_epi8(x, ascii_zero), nine), zero);
+            const __m256i is_sign = _mm256_or_si256(_mm256_cmpeq_epi8(x, space), _mm256_cmpeq_epi8(x, minus));
+            const __m256i is_fixed = _mm256_cmpeq_epi8(x, FAST_PARSE_LOAD256(tables.expected + c * 32));
+            __m256i ok = _mm256_and_si256(is_digit, FAST_PARSE_LOAD256(tables.digit + c * 32));
+            ok = _mm256_or_si256(ok, _mm256_and_si256(is_sign, FAST_PARSE_LOAD256(tables.sign + c * 32)));
+            ok = _mm256_or_si256(ok, _mm256_and_si256(is_fixed, FAST_PARSE_LOAD256(tables.fixed + c * 32)));
+            const uint32_t expected = chunk_mask(c * 2) | chunk_mask(c * 2 + 1) << 16;
+            if (static_cast<uint32_t>(_mm256_movemask_epi8(ok)) != expected) return false;
+        }
+
+        // Fields 4g and 4g + 2 go to slot a, 4g + 1 and 4g + 3 to slot b of the two lanes
+        constexpr size_t GROUPS = (N + 3) / 4;
+        int32_t value[GROUPS * 4];
+        for (size_t g = 0; g < GROUPS; g++) {
+            const __m256i a = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(field(p, g * 4))),
+                                                      _mm_loadu_si128(field(p, g * 4 + 2)), 1);
+            const __m256i b = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(field(p, g * 4 + 1))),
+                                                      _mm_loadu_si128(field(p, g * 4 + 3)), 1);
+            __m256i digits = _mm256_or_si256(_mm256_shuffle_epi8(a, FAST_PARSE_LOAD256(tables.gather_a)),
+                                             _mm256_shuffle_epi8(b, FAST_PARSE_LOAD256(tables.gather_b)));
+            digits = _mm256_subs_epu8(digits, ascii_zero);
+            const __m256i pairs = _mm256_maddubs_epi16(digits, _mm256_set1_epi16(0x010A));
+            const __m256i quads = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00010064));
+            __m256i v = _mm256_madd_epi16(_mm256_packus_epi32(quads, quads), _mm256_set1_epi32(0x00012710));
+
+            const __m256i signs = _mm256_or_si256(_mm256_shuffle_epi8(a, FAST_PARSE_LOAD256(tables.sign_a)),
+                                                  _mm256_shuffle_epi8(b, FAST_PARSE_LOAD256(tables.sign_b)));
+            const __m256i negative = _mm256_cmpeq_epi32(signs, _mm256_set1_epi32('-'));
+            v = _mm256_sub_epi32(_mm256_xor_si256(v, negative), negative);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(value + g * 4),
+                             _mm256_castsi256_si128(_mm256_permute4x64_epi64(v, 0x08)));
+        }
+        memcpy(axis, value, sizeof(axis));
+        return true;
+    }
+
+    __attribute__((target("sse2"))) static const char* find_sse2(const char* p, const char* end) {
+        const __m128i newline = _mm_set1_epi8('\n');
+        for (; end - p >= 16; p += 16) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, newline)));
+            if (mask) return p + __builtin_ctz(mask);
+        }
+        return find_scalar(p, end);
+    }
+
+    __attribute__((target("avx2"))) static const char* find_avx2(const char* p, const char* end) {
+        const __m256i newline = _mm256_set1_epi8('\n');
+        for (; end - p >= 32; p += 32) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, newline)));
+            if (mask) return p + __builtin_ctz(mask);
+        }
+        return find_scalar(p, end);
+    }
+
+    // 16 bytes from the sign of field f on; fields past the last one read the first
+    static const __m128i* field(const char* p, size_t f) {
+        return reinterpret_cast<const __m128i*>(p + (f < N ? f : 0) * FIELD + 7 - D);
+    }
+#endif
+
+    // Bytes of 16 byte chunk c that belong to the line
+    static constexpr uint32_t chunk_mask(size_t c) {
+        if (LINE <= c * 16) return 0;
+        return LINE >= c * 16 + 16 ? 0xFFFF : (1u << (LINE - c * 16)) - 1;
+    }
+
+    static const char* find_scalar(const char* p, const char* end) {
+        const void* found = memchr(p, '\n', static_cast<size_t>(end - p));
+        return found ? static_cast<const char*>(found) : end;
+    }
+
+    // Data lines are taken at once; anything else is skipped up to its newline. The last
+    // WINDOW bytes are parsed from a padded copy, so the line parsers never read past the end.
+    template <bool (*LINE_PARSER)(const char*, int32_t (&)[N]), const char* (*FIND)(const char*, const char*),
+              typename Visit>
+    static stats run(const char* p, const char* end, Visit& visit) {
+        stats s = {0, 0};
+        int32_t axis[N];
+        alignas(32) char tail[WINDOW];
+        while (p < end) {
+            const size_t left = static_cast<size_t>(end - p);
+            const char* line = p;
+            if (left < WINDOW) {
+                memset(tail, 0, sizeof(tail));
+                memcpy(tail, p, left);
+                line = tail;
+            }
+            if (left >= LINE && LINE_PARSER(line, axis)) {
+                visit(axis);
+                s.frames++;
+                p += LINE;
+                continue;
+            }
+            const char* newline = FIND(p, end);
+            s.other++;
+            p = newline == end ? end : newline + 1;
+        }
+        return s;
+    }
+
+    isa which;
+};
+
+}  // namespace fast_parse
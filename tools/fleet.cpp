@@ -0,0 +1,238 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// Fleet of virtual emulators for load tests of receivers, loggers and host tools (see fleet.h)
+//
+// Usage: razmer2m_fleet [-n COUNT] [-r HZ] [-l CODES] [-j THREADS] [-d SECONDS] [-s SEED] [-o pty|DIR]
+//          -n    machines (default 100)
+//          -r    frames per second of every machine (default FRAME_RATE)
+//          -l    comma separated layout codes axes * 100 + digits * 10 + dot, given to the machines in turn
+//                (default the build layout)
+//          -j    worker threads (default one per CPU)
+//          -d    run time in seconds, 0 until interrupted (default 10)
+//          -s    seed of the test patterns (default 1)
+//          -o    pty: one pseudo terminal per machine, printed as "m<index> <path>" at start (default)
+//                DIR: one file per machine, DIR/m<index>.log
+// At the end every stream is reported with its frames, dropped frames, frames written in part and the
+// lateness of its frames (mean, RMS about the mean and maximum), then the aggregate rate against the
+// requested one.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.h"
+#include "fleet.h"
+
+namespace {
+
+volatile sig_atomic_t interrupted = 0;
+
+void on_signal(int) { interrupted = 1; }
+
+int64_t now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void sleep_until(int64_t ns) {
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+    ts.tv_nsec = static_cast<long>(ns % 1000000000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR && !interrupted) {
+    }
+}
+
+void usage() {
+    fputs("usage: razmer2m_fleet [-n COUNT] [-r HZ] [-l CODES] [-j THREADS] [-d SECONDS] [-s SEED] [-o pty|DIR]\n",
+          stderr);
+}
+
+// Pseudo terminal in raw mode, so lines go out as they are
+// The slave side is kept open: the master then takes data while no reader is attached, up to its buffer.
+bool open_pty(int& master, int& slave, std::string& path) {
+    master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return false;
+    path = ptsname(master);
+    slave = open(path.c_str(), O_RDWR | O_NOCTTY);
+    if (slave < 0) return false;
+    termios tio;
+    if (tcgetattr(slave, &tio) != 0) return false;
+    cfmakeraw(&tio);
+    return tcsetattr(slave, TCSANOW, &tio) == 0;
+}
+
+// Every file takes a descriptor, a pty two
+void raise_file_limit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return;
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+}
+
+// Serve the streams of one worker until end_ns
+// A frame that finds the output full is dropped, as a serial line drops what nobody reads; the rest
+// of a frame the output took in part is finished first (see fleet::stream::send).
+void work(fleet::scheduler& streams, int64_t end_ns) {
+    prctl(PR_SET_TIMERSLACK, 1000UL);  // 1 us instead of the default 50 us
+    char frame[fleet::MAX_FRAME_SIZE];
+    while (!streams.empty() && !interrupted) {
+        fleet::stream* s = streams.top();
+        const int64_t due = s->due();
+        if (end_ns && due >= end_ns) {
+            streams.remove();
+            continue;
+        }
+        sleep_until(due);
+        if (interrupted) break;
+        const int64_t now = now_ns();
+        const size_t size = s->source->frame(s->ticks(now), frame);
+        s->send(frame, size, [s](const char* data, size_t length) { return write(s->fd, data, length); });
+        s->late.add(now - due);
+        streams.advance();
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    unsigned count = 100, threads = std::thread::hardware_concurrency();
+    long rate = FRAME_RATE;
+    double duration = 10;
+    uint32_t seed = 1;
+    std::string output = "pty";
+    std::vector<uint16_t> codes;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "-n" && has_value) {
+            count = static_cast<unsigned>(atoi(argv[++i]));
+        } else if (arg == "-r" && has_value) {
+            rate = atol(argv[++i]);
+        } else if (arg == "-l" && has_value) {
+            for (char* p = argv[++i]; *p;) {
+                char* end;
+                codes.push_back(static_cast<uint16_t>(strtoul(p, &end, 10)));
+                if (end == p || !fleet::valid(codes.back())) {
+                    fprintf(stderr, "bad layout code in %s\n", argv[i]);
+                    return 2;
+                }
+                p = *end == ',' ? end + 1 : end;
+            }
+        } else if (arg == "-j" && has_value) {
+            threads = static_cast<unsigned>(atoi(argv[++i]));
+        } else if (arg == "-d" && has_value) {
+            duration = atof(argv[++i]);
+        } else if (arg == "-s" && has_value) {
+            seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "-o" && has_value) {
+            output = argv[++i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (count == 0 || rate < 1 || rate > 65535 || duration < 0) {
+        usage();
+        return 2;
+    }
+    if (codes.empty()) codes.push_back(layout::code(AXIS_COUNT, AXIS_DIGIT_COUNT, AXIS_DOT_POSITION));
+    threads = std::max(1u, std::min(threads, count));
+
+    raise_file_limit();
+    std::vector<fleet::stream> streams(count);
+    for (unsigned i = 0; i < count; i++) {
+        fleet::stream& s = streams[i];
+        const uint16_t code = codes[i % codes.size()];
+        s.rate = static_cast<uint16_t>(rate);
+        s.source = fleet::make(code, s.rate, seed + i);
+        s.uptime = static_cast<uint32_t>(std::minstd_rand(seed + i)());
+
+        char name[16];
+        snprintf(name, sizeof(name), "m%03u", i);
+        std::string path;
+        if (output == "pty") {
+            int slave;
+            if (!open_pty(s.fd, slave, path)) {
+                fprintf(stderr, "%s: pty: %s\n", name, strerror(errno));
+                return 1;
+            }
+        } else {
+            path = output + "/" + name + ".log";
+            s.fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (s.fd < 0) {
+                fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+                return 1;
+            }
+        }
+        printf("%s %u %s\n", name, code, path.c_str());
+    }
+    fflush(stdout);
+
+    // Machines start spread over one frame, so the writes of the fleet are spread evenly
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    const int64_t start = now_ns() + 100000000;
+    const int64_t end = duration > 0 ? start + static_cast<int64_t>(duration * 1e9) : 0;
+    std::vector<fleet::scheduler> workers(threads);
+    for (unsigned i = 0; i < count; i++) {
+        streams[i].start_ns = start + fleet::deadline_ns(i, static_cast<uint32_t>(rate)) / count;
+        workers[i % threads].add(&streams[i]);
+    }
+    std::vector<std::thread> pool;
+    for (fleet::scheduler& w : workers) pool.emplace_back(work, std::ref(w), end);
+    for (std::thread& t : pool) t.join();
+    const double elapsed = static_cast<double>((end ? std::min(end, now_ns()) : now_ns()) - start) / 1e9;
+
+    // Per stream and aggregate report
+    uint64_t frames = 0, dropped = 0, partial = 0, bytes = 0;
+    double worst_rms = 0, worst_max = 0;
+    fprintf(stderr, "stream   frames  dropped  partial  late mean us  jitter rms us  late max us\n");
+    for (unsigned i = 0; i < count; i++) {
+        const fleet::stream& s = streams[i];
+        fprintf(stderr, "m%03u  %9llu  %7llu  %7llu  %12.1f  %13.1f  %11.1f\n", i, (unsigned long long)s.late.count(),
+                (unsigned long long)s.dropped, (unsigned long long)s.partial, s.late.mean_us(), s.late.rms_us(),
+                s.late.max_us());
+        frames += s.late.count();
+        dropped += s.dropped;
+        partial += s.partial;
+        bytes += s.bytes;
+        worst_rms = std::max(worst_rms, s.late.rms_us());
+        worst_max = std::max(worst_max, s.late.max_us());
+    }
+    fprintf(stderr,
+            "%u machines on %u threads, %.2f s: %.1f frames/s of %ld requested, %.0f bytes/s, %llu dropped, "
+            "%llu partial, worst jitter %.1f us rms, %.1f us max\n",
+            count, threads, elapsed, elapsed > 0 ? static_cast<double>(frames) / elapsed : 0.0, rate * count,
+            elapsed > 0 ? static_cast<double>(bytes) / elapsed : 0.0, (unsigned long long)dropped,
+            (unsigned long long)partial, worst_rms, worst_max);
+    return 0;
+}
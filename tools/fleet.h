@@ -0,0 +1,254 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "format.h"
+#include "layout.h"
+#include "pattern.h"
+#include "stamp.h"
+
+// Fleet of virtual emulators on the host (see fleet.cpp)
+// Every machine sends what the emulator firmware sends: its test patterns (pattern.h) as data lines in the
+// format() layout, each after a "#t" time stamp, and a "#s" sync line once a second. Machines differ in
+// layout and frame rate and run as plain objects: a worker thread serves many of them, earliest deadline
+// first. Deadlines are computed from the frame index, so rounding and late frames never drift the rate.
+namespace fleet {
+
+// Ticks of the "#t" time stamps (see uptime.h, F_CPU / 8 at 16 MHz)
+constexpr uint32_t TICKS_PER_US = 2;
+
+// Largest layout of the firmware (see config.h)
+constexpr uint8_t MAX_AXES = 5;
+constexpr uint8_t MAX_DIGITS = 7;
+
+// Longest frame: sync line, time stamp line and data line
+constexpr size_t MAX_FRAME_SIZE = 2 * stamp::LINE_SIZE + MAX_AXES * 10;
+
+constexpr bool valid(uint16_t code) {
+    return code < 1000 && layout::axes(code) >= 1 && layout::axes(code) <= MAX_AXES && layout::digits(code) >= 1 &&
+           layout::digits(code) <= MAX_DIGITS && layout::dot(code) <= layout::digits(code);
+}
+
+// Deadline of a frame, in nanoseconds from the first one
+constexpr int64_t deadline_ns(uint64_t index, uint32_t rate) {
+    return static_cast<int64_t>(index / rate * 1000000000 + index % rate * 1000000000 / rate);
+}
+
+// Virtual emulator
+class machine {
+   public:
+    virtual ~machine() = default;
+
+    // Write the lines of the next frame at an uptime in ticks, returns the number of bytes
+    virtual size_t frame(uint32_t ticks, char* out) = 0;
+};
+
+// Emulator of N axes of D digits with the dot at P
+// Seeded minstd_rand stands in for the AVR rand(); the generator takes its low 8 bits.
+template <size_t N, int D, int P>
+class emulator final : public machine {
+   public:
+    emulator(uint16_t frame_rate, uint32_t seed) : rate(frame_rate), random(seed) {}
+
+    size_t frame(uint32_t ticks, char* out) override {
+        char* p = out;
+        if (sync_counter == 0) p = stamp::write(p, stamp::SYNC, ticks);
+        if (++sync_counter >= rate) sync_counter = 0;
+
+        int64_t next[N];
+        memcpy(next, value, sizeof(value));
+        generator.next(algorithm, value, next, rate, [this] { return random(); });
+        memcpy(value, next, sizeof(value));
+
+        p = stamp::write(p, stamp::TIME, ticks);
+        format<N, D, P>(value, p);
+        p += strlen(p);
+
+        if (++frame_counter >= static_cast<uint32_t>(rate) * pattern::CYCLE_SECONDS) {
+            frame_counter = 0;
+            algorithm = pattern::following(algorithm);
+        }
+        return static_cast<size_t>(p - out);
+    }
+
+   private:
+    uint16_t rate;
+    std::minstd_rand random;
+    pattern::generator<N, D> generator;
+    pattern::algorithm_t algorithm = pattern::algorithm_t::RANDOM;
+    int64_t value[N] = {};
+    uint16_t sync_counter = 0;
+    uint32_t frame_counter = 0;
+};
+
+// Emulator of a layout code, nullptr if the code names no layout
+// Every layout is compiled in: a table of 5 * 8 * 8 constructors, indexed by axes, digits and dot.
+using factory_t = std::unique_ptr<machine> (*)(uint16_t rate, uint32_t seed);
+
+template <size_t I>
+constexpr factory_t factory_at() {
+    constexpr uint16_t CODE = layout::code(I / 64 + 1, I / 8 % 8, I % 8);
+    if constexpr (valid(CODE)) {
+        return [](uint16_t rate, uint32_t seed) -> std::unique_ptr<machine> {
+            return std::make_unique<emulator<layout::axes(CODE), layout::digits(CODE), layout::dot(CODE)>>(rate,
+                                                                                                          seed);
+        };
+    } else {
+        return nullptr;
+    }
+}
+
+template <size_t... I>
+constexpr std::array<factory_t, sizeof...(I)> factories(std::index_sequence<I...>) {
+    return {factory_at<I>()...};
+}
+
+inline std::unique_ptr<machine> make(uint16_t code, uint16_t rate, uint32_t seed) {
+    static constexpr auto TABLE = factories(std::make_index_sequence<MAX_AXES * 64>());
+    if (!valid(code) || rate == 0) return nullptr;
+    const factory_t f = TABLE[(layout::axes(code) - 1) * 64 + layout::digits(code) * 8 + layout::dot(code)];
+    return f(rate, seed);
+}
+
+// Send time statistics of one stream
+// Lateness is the send time minus the deadline. A constant lateness does not disturb a receiver, its
+// spread does: jitter is the RMS of the lateness about its mean.
+class jitter {
+   public:
+    void add(int64_t late_ns) {
+        count_++;
+        const double x = static_cast<double>(late_ns);
+        const double delta = x - mean;
+        mean += delta / static_cast<double>(count_);
+        m2 += delta * (x - mean);
+        max_ = std::max(max_, late_ns);
+    }
+
+    uint64_t count() const { return count_; }
+    double mean_us() const { return mean / 1000; }
+    double rms_us() const { return count_ > 1 ? std::sqrt(m2 / static_cast<double>(count_)) / 1000 : 0; }
+    double max_us() const { return static_cast<double>(max_) / 1000; }
+
+   private:
+    uint64_t count_ = 0;
+    double mean = 0;  // Welford's running mean and sum of squares
+    double m2 = 0;
+    int64_t max_ = 0;
+};
+
+// Machine with its output and schedule
+struct stream {
+    std::unique_ptr<machine> source;
+    int fd = -1;
+    uint16_t rate = 0;
+    int64_t start_ns = 0;   // Deadline of the first frame
+    uint32_t uptime = 0;    // Machine uptime at start_ns, in ticks
+    uint64_t index = 0;     // Next frame
+    uint64_t bytes = 0;     // Written
+    uint64_t dropped = 0;   // Frames the output did not take
+    uint64_t partial = 0;   // Frames the output took in part, finished before the next one
+    jitter late;
+
+    int64_t due() const { return start_ns + deadline_ns(index, rate); }
+
+    // Send a frame through `out`, which writes like write(2) on a non-blocking descriptor
+    // What is left of a frame the output took in part goes out first, so no line is cut; while
+    // it does not fit the new frame is dropped whole, as is a frame the output takes nothing of.
+    template <typename Write>
+    void send(const char* frame, size_t size, Write&& out) {
+        if (rest_size != 0 && !finish(out)) {
+            dropped++;
+            return;
+        }
+        const auto n = out(frame, size);
+        if (n <= 0) {
+            dropped++;
+            return;
+        }
+        const size_t sent = static_cast<size_t>(n);
+        bytes += sent;
+        if (sent == size) return;
+        partial++;
+        rest_size = size - sent;
+        memcpy(rest, frame + sent, rest_size);
+    }
+
+    // Uptime of the machine at a time, wraps like the firmware's
+    uint32_t ticks(int64_t now_ns) const {
+        return uptime + static_cast<uint32_t>((now_ns - start_ns) / (1000 / TICKS_PER_US));
+    }
+
+   private:
+    // Write what is left of the last frame, true once all of it is out
+    template <typename Write>
+    bool finish(Write& out) {
+        const auto n = out(rest, rest_size);
+        if (n > 0) {
+            const size_t sent = static_cast<size_t>(n);
+            bytes += sent;
+            rest_size -= sent;
+            memmove(rest, rest + sent, rest_size);
+        }
+        return rest_size == 0;
+    }
+
+    char rest[MAX_FRAME_SIZE];
+    size_t rest_size = 0;
+};
+
+// Streams of one worker, earliest deadline first
+class scheduler {
+   public:
+    void add(stream* s) {
+        heap.push_back(s);
+        std::push_heap(heap.begin(), heap.end(), later);
+    }
+
+    bool empty() const { return heap.empty(); }
+    stream* top() const { return heap.front(); }
+
+    // The top stream sent its frame: on to its next one
+    void advance() {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        heap.back()->index++;
+        std::push_heap(heap.begin(), heap.end(), later);
+    }
+
+    // The top stream is done
+    void remove() {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        heap.pop_back();
+    }
+
+   private:
+    static bool later(const stream* a, const stream* b) { return a->due() > b->due(); }
+    std::vector<stream*> heap;
+};
+
+}  // namespace fleet
@@ -0,0 +1,123 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// G-code to toolpath compiler (see gcode.h and toolpath.h)
+// Writes a header with the compiled program as toolpath::DATA in PROGMEM, for the emulator
+// toolpath mode, followed by statistics. Built with the display parameters of the firmware.
+//
+// Usage: razmer2m_gcode [options] program.nc
+//   -a AXES    program axes shown on the displays, in display order (default XYZABC)
+//   -r MM      G0 feed rate in mm/min (default 5000)
+//   -t UNITS   allowed error of the playback in displayed units (default 1, 0 is exact)
+//   -o FILE    write the header to FILE instead of stdout
+//   -q         do not print statistics
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "gcode.h"
+#include "mapped_file.h"
+#include "toolpath.h"
+
+namespace {
+
+void usage() { fputs("usage: razmer2m_gcode [-a AXES] [-r MM] [-t UNITS] [-o FILE] [-q] program\n", stderr); }
+
+void write_header(FILE* out, const std::string& input, const std::vector<uint8_t>& stream, size_t frames) {
+    fprintf(out, "// Generated by razmer2m_gcode from %s, do not edit\n", input.c_str());
+    fprintf(out, "#pragma once\n\n#include \"toolpath.h\"\n\nnamespace toolpath {\n\n");
+    fprintf(out, "static_assert(AXIS_COUNT == %d, \"toolpath compiled for another axis count\");\n", AXIS_COUNT);
+    fprintf(out, "static_assert(AXIS_DIGIT_COUNT == %d && AXIS_DOT_POSITION == %d, ", AXIS_DIGIT_COUNT,
+            AXIS_DOT_POSITION);
+    fprintf(out, "\"toolpath compiled for other units\");\n");
+    fprintf(out, "static_assert(FRAME_RATE == %d, \"toolpath compiled for another frame rate\");\n\n", FRAME_RATE);
+    fprintf(out, "constexpr uint32_t FRAMES = %zu;\n\n", frames);
+    fprintf(out, "const uint8_t DATA[] PROGMEM = {");
+    for (size_t i = 0; i < stream.size(); i++) {
+        fprintf(out, i % 16 == 0 ? "\n    0x%02x," : " 0x%02x,", stream[i]);
+    }
+    fprintf(out, "\n};\n\n}  // namespace toolpath\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string input, output;
+    gcode::settings settings;
+    settings.units_per_mm = gcode::display_units_per_mm(AXIS_DIGIT_COUNT, AXIS_DOT_POSITION);
+    int32_t tolerance = 1;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "-a" && has_value) {
+            settings.axes = argv[++i];
+        } else if (arg == "-r" && has_value) {
+            settings.rapid_mm_per_min = strtod(argv[++i], nullptr);
+        } else if (arg == "-t" && has_value) {
+            tolerance = static_cast<int32_t>(strtol(argv[++i], nullptr, 10));
+        } else if (arg == "-o" && has_value) {
+            output = argv[++i];
+        } else if (arg == "-q") {
+            quiet = true;
+        } else if (arg[0] != '-' && input.empty()) {
+            input = arg;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (input.empty() || settings.rapid_mm_per_min <= 0 || tolerance < 0) {
+        usage();
+        return 2;
+    }
+
+    std::string error;
+    mapped_file file;
+    if (!file.open(input.c_str(), error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    gcode::interpreter program(settings, AXIS_COUNT);
+    if (!program.run(file.begin(), file.end(), error)) {
+        fprintf(stderr, "%s: %s\n", input.c_str(), error.c_str());
+        return 1;
+    }
+    size_t records = 0;
+    std::vector<uint8_t> stream = gcode::encode(program.samples(), AXIS_COUNT, tolerance, &records);
+
+    FILE* out = output.empty() ? stdout : fopen(output.c_str(), "w");
+    if (!out) {
+        fprintf(stderr, "cannot create %s\n", output.c_str());
+        return 1;
+    }
+    write_header(out, input, stream, program.frames());
+    if (out != stdout) fclose(out);
+
+    if (!quiet) {
+        double seconds = static_cast<double>(program.frames()) / FRAME_RATE;
+        fprintf(stderr, "%s: %zu frames (%d:%02d), %zu records, %zu bytes (%.0f bytes per minute)\n", input.c_str(),
+                program.frames(), static_cast<int>(seconds) / 60, static_cast<int>(seconds) % 60, records,
+                stream.size(), seconds > 0 ? stream.size() * 60 / seconds : 0.0);
+    }
+    return 0;
+}
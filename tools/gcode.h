@@ -0,0 +1,378 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "toolpath.h"
+
+// G-code to toolpath compiler (see toolpath.h)
+// The interpreter runs the program at the programmed feed rates, without acceleration, and samples the
+// position of every axis FRAME_RATE times a second, in units of the last displayed digit. The encoder
+// then fits fixed point steps to the samples.
+//
+// Supported: G0 G1 G2 G3 (I J K or R), G4 (P seconds), G17 G18 G19, G20 G21, G90 G91, F, M2 M30.
+// Comments in parentheses or after ';' are skipped, other words (N, S, T, M, G54...) are ignored.
+namespace gcode {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Letters of the program axes, output axis i shows program axis LETTERS[map[i]]
+constexpr char LETTERS[] = "XYZABC";
+constexpr int LETTER_COUNT = 6;
+
+struct settings {
+    std::string axes = "XYZABC";          // Program axis shown on display 0, 1, ...
+    double units_per_mm = 1;              // Units of the last displayed digit per millimetre (or degree)
+    double rapid_mm_per_min = 5000;       // G0 feed rate
+    double frame_rate = FRAME_RATE;       // Samples per second
+};
+
+// Display units per millimetre: the digits after the dot
+constexpr double display_units_per_mm(int digits, int dot) {
+    double units = 1;
+    for (int i = dot; i < digits; i++) units *= 10;
+    return units;
+}
+
+class interpreter {
+   public:
+    interpreter(const settings& s, size_t axis_count) : config(s), axes(axis_count) {
+        for (size_t i = 0; i < axes; i++) {
+            const char* letter = i < config.axes.size() ? strchr(LETTERS, config.axes[i]) : nullptr;
+            map.push_back(letter ? static_cast<int>(letter - LETTERS) : -1);
+        }
+        sample();  // Frame 0
+    }
+
+    // Run a whole program, returns false with an error message on a line that cannot be executed
+    bool run(const char* begin, const char* end, std::string& error) {
+        int number = 0;
+        const char* line = begin;
+        while (line < end && !stopped) {
+            const char* eol = line;
+            while (eol < end && *eol != '\n') eol++;
+            number++;
+            if (!execute(std::string(line, eol), error)) {
+                error = "line " + std::to_string(number) + ": " + error;
+                return false;
+            }
+            line = eol + 1;
+        }
+        return true;
+    }
+
+    // Axis values of every frame, frame after frame
+    const std::vector<int32_t>& samples() const { return values; }
+    size_t frames() const { return values.size() / axes; }
+
+   private:
+    struct word {
+        char letter;
+        double value;
+    };
+
+    bool execute(const std::string& text, std::string& error) {
+        std::vector<word> words;
+        if (!split(text, words, error)) return false;
+
+        double target[LETTER_COUNT];
+        bool has_target = false, has_i = false, has_r = false;
+        bool dwell = false;
+        double offset[3] = {0, 0, 0}, radius = 0, seconds = 0;
+        for (int i = 0; i < LETTER_COUNT; i++) target[i] = position[i];
+
+        for (const word& w : words) {
+            const char* letter = strchr(LETTERS, w.letter);
+            if (w.letter == 'G') {
+                // Codes times 10, so G17 and G17.1 differ
+                int code = static_cast<int>(lround(w.value * 10));
+                if (code <= 30 && code % 10 == 0) {
+                    motion = code / 10;
+                } else if (code == 40) {
+                    dwell = true;
+                } else if (code >= 170 && code <= 190 && code % 10 == 0) {
+                    plane = code / 10 - 17;
+                } else if (code == 200 || code == 210) {
+                    scale = code == 200 ? 25.4 : 1;
+                } else if (code == 900 || code == 910) {
+                    absolute = code == 900;
+                }
+            } else if (w.letter == 'M') {
+                int code = static_cast<int>(lround(w.value));
+                if (code == 2 || code == 30) stopped = true;
+            } else if (w.letter == 'F') {
+                feed = w.value * scale;
+            } else if (w.letter == 'P') {
+                seconds = w.value;
+            } else if (w.letter == 'R') {
+                radius = w.value * scale;
+                has_r = true;
+            } else if (w.letter == 'I' || w.letter == 'J' || w.letter == 'K') {
+                offset[w.letter - 'I'] = w.value * scale;
+                has_i = true;
+            } else if (letter && *letter) {
+                int axis = static_cast<int>(letter - LETTERS);
+                double v = w.value * (axis < 3 ? scale : 1);
+                target[axis] = absolute ? v : target[axis] + v;
+                has_target = true;
+            }
+        }
+
+        if (dwell) {
+            hold(seconds * config.frame_rate);
+            return true;
+        }
+        if (!has_target) return true;
+        if (motion == 0) return line(target, config.rapid_mm_per_min, error);
+        if (feed <= 0) {
+            error = "feed rate is not set";
+            return false;
+        }
+        if (motion == 1) return line(target, feed, error);
+        if (!has_i && !has_r) {
+            error = "arc without I, J, K or R";
+            return false;
+        }
+        return arc(target, offset, has_r ? radius : 0, motion == 2, error);
+    }
+
+    static bool split(const std::string& text, std::vector<word>& words, std::string& error) {
+        size_t i = 0;
+        while (i < text.size()) {
+            char c = text[i];
+            if (c == ';' || c == '%') break;
+            if (c == '(') {
+                i = text.find(')', i);
+                if (i == std::string::npos) break;
+                i++;
+                continue;
+            }
+            if (c == ' ' || c == '\t' || c == '\r') {
+                i++;
+                continue;
+            }
+            if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+            if (c < 'A' || c > 'Z') {
+                error = std::string("unexpected '") + text[i] + "'";
+                return false;
+            }
+            const char* start = text.c_str() + i + 1;
+            char* stop;
+            double value = strtod(start, &stop);
+            if (stop == start) {
+                error = std::string("missing number after ") + c;
+                return false;
+            }
+            words.push_back({c, value});
+            i = static_cast<size_t>(stop - text.c_str());
+        }
+        return true;
+    }
+
+    // Duration in frames of a path at a feed rate in mm/min
+    double frames_for(double length, double mm_per_min) const { return length / mm_per_min * 60 * config.frame_rate; }
+
+    void hold(double duration) {
+        time += duration;
+        while (next_frame <= time) sample();
+    }
+
+    bool line(const double* target, double mm_per_min, std::string& error) {
+        double start[LETTER_COUNT], length = 0;
+        for (int i = 0; i < LETTER_COUNT; i++) {
+            start[i] = position[i];
+            length += (target[i] - start[i]) * (target[i] - start[i]);
+        }
+        length = sqrt(length);
+        if (mm_per_min <= 0) {
+            error = "feed rate is not set";
+            return false;
+        }
+        move(frames_for(length, mm_per_min), [&](double u) {
+            for (int i = 0; i < LETTER_COUNT; i++) position[i] = start[i] + (target[i] - start[i]) * u;
+        });
+        for (int i = 0; i < LETTER_COUNT; i++) position[i] = target[i];
+        return true;
+    }
+
+    bool arc(const double* target, const double* offset, double r, bool clockwise, std::string& error) {
+        // Plane axes (a, b) and the axis across the plane
+        static const int PLANES[3][3] = {{0, 1, 2}, {2, 0, 1}, {1, 2, 0}};
+        const int a = PLANES[plane][0], b = PLANES[plane][1];
+        const double start_a = position[a], start_b = position[b];
+        const double da = target[a] - start_a, db = target[b] - start_b;
+
+        double center_a, center_b;
+        if (r != 0) {
+            // Center on the bisector of the chord, left of it for G3 with R > 0
+            double chord = sqrt(da * da + db * db);
+            if (chord == 0 || fabs(r) < chord / 2 - 1e-9) {
+                error = "arc radius too small";
+                return false;
+            }
+            double h = sqrt(fmax(r * r - chord * chord / 4, 0));
+            if (clockwise == (r > 0)) h = -h;
+            center_a = start_a + da / 2 - h * db / chord;
+            center_b = start_b + db / 2 + h * da / chord;
+        } else {
+            center_a = start_a + offset[a];
+            center_b = start_b + offset[b];
+        }
+
+        const double radius = hypot(start_a - center_a, start_b - center_b);
+        const double from = atan2(start_b - center_b, start_a - center_a);
+        double sweep = atan2(target[b] - center_b, target[a] - center_a) - from;
+        if (clockwise && sweep >= -1e-12) sweep -= 2 * PI;
+        if (!clockwise && sweep <= 1e-12) sweep += 2 * PI;
+
+        double start[LETTER_COUNT], linear = 0;
+        for (int i = 0; i < LETTER_COUNT; i++) {
+            start[i] = position[i];
+            if (i != a && i != b) linear += (target[i] - start[i]) * (target[i] - start[i]);
+        }
+        double length = sqrt(radius * sweep * radius * sweep + linear);
+        move(frames_for(length, feed), [&](double u) {
+            for (int i = 0; i < LETTER_COUNT; i++) position[i] = start[i] + (target[i] - start[i]) * u;
+            position[a] = center_a + radius * cos(from + sweep * u);
+            position[b] = center_b + radius * sin(from + sweep * u);
+        });
+        for (int i = 0; i < LETTER_COUNT; i++) position[i] = target[i];
+        return true;
+    }
+
+    // Sample every frame that falls into a move of a duration, at(u) sets the position at u in 0..1
+    template <typename At>
+    void move(double duration, At&& at) {
+        double start = time;
+        time += duration;
+        double saved[LETTER_COUNT];
+        for (int i = 0; i < LETTER_COUNT; i++) saved[i] = position[i];
+        while (next_frame <= time) {
+            at(duration > 0 ? (next_frame - start) / duration : 1.0);
+            sample();
+        }
+        for (int i = 0; i < LETTER_COUNT; i++) position[i] = saved[i];
+    }
+
+    void sample() {
+        for (size_t i = 0; i < axes; i++) {
+            double units = map[i] < 0 ? 0 : position[map[i]] * config.units_per_mm;
+            double limit = static_cast<double>(MAX_AXIS_ABS);
+            values.push_back(static_cast<int32_t>(llround(fmax(-limit, fmin(limit, units)))));
+        }
+        next_frame += 1;
+    }
+
+    settings config;
+    size_t axes;
+    std::vector<int> map;
+    std::vector<int32_t> values;
+
+    double position[LETTER_COUNT] = {0, 0, 0, 0, 0, 0};
+    double time = 0;        // Program time in frames
+    double next_frame = 0;  // Time of the next sample in frames
+    double feed = 0;        // mm/min
+    double scale = 1;       // mm per program unit
+    int motion = 0;
+    int plane = 0;
+    bool absolute = true;
+    bool stopped = false;
+};
+
+// Fit the toolpath records to the samples, returns the stream (see toolpath.h)
+// Every record is made as long as one step per axis keeps every frame within tolerance units of its sample:
+// 0 plays the samples back exactly, 1 lets arcs run several times longer records.
+inline std::vector<uint8_t> encode(const std::vector<int32_t>& samples, size_t axes, int32_t tolerance = 0,
+                                   size_t* records = nullptr) {
+    using toolpath::STEP_FRACTION_BITS;
+    std::vector<uint8_t> out;
+    auto varint = [&](uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    };
+    auto floor_div = [](int64_t a, int64_t b) { return a / b - ((a % b != 0) && ((a < 0) != (b < 0))); };
+    auto ceil_div = [&](int64_t a, int64_t b) { return -floor_div(-a, b); };
+
+    const size_t frames = samples.size() / axes;
+    const int64_t one = int64_t(1) << STEP_FRACTION_BITS;
+    const int64_t slack = tolerance * one;
+    std::vector<int64_t> position(axes), step(axes, 0), lo(axes), hi(axes), next_lo(axes), next_hi(axes);
+    for (size_t i = 0; i < axes && frames > 0; i++) {
+        varint(toolpath::zigzag(samples[i]));
+        position[i] = samples[i] * one + toolpath::START_FRACTION;
+    }
+    if (records) *records = 0;
+
+    size_t frame = 0;
+    while (frame + 1 < frames) {
+        // Longest run of frames with a common step range for every axis
+        size_t count = 0;
+        for (size_t i = 0; i < axes; i++) {
+            lo[i] = INT32_MIN;
+            hi[i] = INT32_MAX;
+        }
+        while (frame + count + 1 < frames && count < toolpath::MAX_FRAMES) {
+            const int64_t k = static_cast<int64_t>(count + 1);
+            bool fits = true;
+            for (size_t i = 0; i < axes && fits; i++) {
+                const int64_t target = samples[(frame + count + 1) * axes + i] * one;
+                next_lo[i] = std::max(lo[i], ceil_div(target - slack - position[i], k));
+                next_hi[i] = std::min(hi[i], floor_div(target + slack + one - 1 - position[i], k));
+                fits = next_lo[i] <= next_hi[i];
+            }
+            if (!fits) break;
+            lo.swap(next_lo);
+            hi.swap(next_hi);
+            count++;
+        }
+
+        // Keep the steps that still fit; a new step ends the record as close to the middle of the
+        // last sample as it can, which leaves the next record the most room
+        uint8_t mask = 0;
+        for (size_t i = 0; i < axes; i++) {
+            if (step[i] >= lo[i] && step[i] <= hi[i]) continue;
+            mask = static_cast<uint8_t>(mask | (1 << i));
+            const int64_t middle = samples[(frame + count) * axes + i] * one + one / 2;
+            const int64_t k = static_cast<int64_t>(count);
+            step[i] = std::min(hi[i], std::max(lo[i], floor_div(middle - position[i] + k / 2, k)));
+        }
+        out.push_back(mask);
+        varint(static_cast<uint32_t>(count));
+        for (size_t i = 0; i < axes; i++) {
+            if (mask & (1 << i)) varint(toolpath::zigzag(static_cast<int32_t>(step[i])));
+            position[i] += step[i] * static_cast<int64_t>(count);
+        }
+        frame += count;
+        if (records) (*records)++;
+    }
+    out.push_back(toolpath::END);
+    return out;
+}
+
+}  // namespace gcode
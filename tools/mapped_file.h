@@ -0,0 +1,78 @@
+//    This is a part of the Razmer2M project
+//    Copyright (C) 2025-... Oleksandr Kolodkin <oleksandr.kolodkin@ukr.net>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+
+// Read-only memory mapping of a whole file (POSIX)
+// Pages are read in by the kernel as the parser walks forward, so captures larger than RAM work too.
+class mapped_file {
+   public:
+    mapped_file() = default;
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    ~mapped_file() { close(); }
+
+    // Returns false and sets error if the file cannot be mapped
+    bool open(const char* path, std::string& error) {
+        close();
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            error = std::string("cannot open ") + path;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            error = std::string("cannot stat ") + path;
+            return false;
+        }
+        length = static_cast<size_t>(st.st_size);
+        if (length != 0) {
+            void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                length = 0;
+                error = std::string("cannot map ") + path;
+                return false;
+            }
+            // One pass from start to end: read ahead aggressively, drop pages behind
+            madvise(mapping, length, MADV_SEQUENTIAL);
+            address = static_cast<const char*>(mapping);
+        }
+        ::close(fd);
+        return true;
+    }
+
+    void close() {
+        if (address) munmap(const_cast<char*>(address), length);
+        address = nullptr;
+        length = 0;
+    }
+
+    const char* begin() const { return address; }
+    const char* end() const { return address + length; }
+    size_t size() const { return length; }
+
+   private:
+    const char* address = nullptr;
+    size_t length = 0;
+};